@@ -0,0 +1,18 @@
+#pragma once
+
+namespace unimath
+{
+	/**
+	 * How matrix kernels sum up products of K.
+	 * The default adds every product to a K directly. Specializations can use
+	 * a wider or unnormalized type and convert back once per result entry.
+	 */
+	template<typename K>
+	struct accumulator_traits
+	{
+		using type = K;
+
+		static void add_product(type& sum, const K& a, const K& b) { sum += a * b; }
+		static K value(const type& sum) { return sum; }
+	};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "fraction.hpp"
+#include "matrix.hpp"
+#include "types.hpp"
+
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Fraction-free Gauss-Jordan elimination (Bareiss) of an integer matrix in place.
+	 * Every update is of the form (p*a - q*b)/d with d being the previous pivot,
+	 * and the division is always exact, so all entries stay integers and are
+	 * bounded by minors of the input.
+	 * Afterwards every pivot row i holds the same value d in column pivots[i] and
+	 * zeros in all other pivot columns, so dividing by d gives the reduced row echelon form.
+	 * Returns the pivot columns. If sign is given, it receives the sign of the row permutation.
+	 * Throws std::overflow_error if an entry does not fit into Z.
+	 */
+	std::vector<int> bareiss(matrix<Z>& m, int* sign = nullptr);
+
+	/**
+	 * Multiplies every row of a rational matrix with the least common multiple
+	 * of its denominators, so all entries become integers.
+	 * The factors are stored in scale.
+	 */
+	matrix<Z> integer_rows(const matrix<fraction>& m, std::vector<Z>& scale);
+
+	/**
+	 * Computes the determinant of an integer matrix using fraction-free elimination.
+	 */
+	Z bareiss_det(matrix<Z> m);
+
+	/**
+	 * Computes the reduced row echelon form of a rational matrix.
+	 * The rows are scaled to integers once, eliminated fraction-free and only
+	 * reduced back to fractions at the end.
+	 */
+	matrix<fraction> bareiss_nzsf(const matrix<fraction>& m, std::vector<int>* pivots = nullptr);
+	/**
+	 * Computes the determinant of a rational matrix using fraction-free elimination.
+	 */
+	fraction bareiss_det(const matrix<fraction>& m);
+	/**
+	 * Computes the inverse of a rational matrix using fraction-free elimination.
+	 */
+	matrix<fraction> bareiss_inverse(const matrix<fraction>& m);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "big_integer.hpp"
+#include "fraction.hpp"
+
+#include <compare>
+#include <ostream>
+
+namespace unimath
+{
+	/**
+	 * Exact rational number with big_integer numerator and denominator.
+	 * The value is always reduced and the denominator is positive. Arithmetic
+	 * follows Knuth's cross-cancellation, so intermediate products never grow
+	 * beyond what the reduced result needs.
+	 */
+	class big_fraction
+	{
+		public:
+			big_fraction(int p = 0) : m_p(p), m_q(1) {}
+			big_fraction(long p) : m_p(p), m_q(1) {}
+			big_fraction(big_integer p) : m_p(std::move(p)), m_q(1) {}
+			/**
+			 * Throws std::domain_error if q is zero.
+			 */
+			big_fraction(big_integer p, big_integer q);
+			big_fraction(const fraction& f) : m_p(f.numerator()), m_q(f.denominator()) {}
+
+			const big_integer& numerator() const { return m_p; }
+			const big_integer& denominator() const { return m_q; }
+
+			friend bool operator==(const big_fraction& a, const big_fraction& b)
+			{
+				return a.m_p == b.m_p && a.m_q == b.m_q;
+			}
+			friend std::strong_ordering operator<=>(const big_fraction& a, const big_fraction& b);
+
+			friend big_fraction operator+(const big_fraction& a, const big_fraction& b);
+			friend big_fraction operator-(const big_fraction& a, const big_fraction& b);
+			friend big_fraction operator*(const big_fraction& a, const big_fraction& b);
+			/**
+			 * Throws std::domain_error on division by zero.
+			 */
+			friend big_fraction operator/(const big_fraction& a, const big_fraction& b);
+
+			big_fraction& operator+=(const big_fraction& other) { return *this = *this + other; }
+			big_fraction& operator-=(const big_fraction& other) { return *this = *this - other; }
+			big_fraction& operator*=(const big_fraction& other) { return *this = *this * other; }
+			big_fraction& operator/=(const big_fraction& other) { return *this = *this / other; }
+
+			big_fraction operator-() const;
+
+			explicit operator double() const;
+		private:
+			big_integer m_p;
+			big_integer m_q;
+
+			struct reduced {};
+			big_fraction(big_integer p, big_integer q, reduced) : m_p(std::move(p)), m_q(std::move(q)) {}
+			static big_fraction add(const big_fraction& a, const big_fraction& b, bool subtract);
+	};
+
+	void render(render_buffer& buffer, const big_fraction& f);
+	std::ostream& operator<<(std::ostream& out, const big_fraction& f);
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <compare>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace unimath
+{
+	class render_buffer;
+
+	/**
+	 * Arbitrary precision integer.
+	 * Values that fit into a long are stored inline and handled by inlined
+	 * fast paths that only check for overflow. Larger values are promoted to
+	 * a heap allocated magnitude of 64 bit limbs; products of large values use
+	 * Karatsuba multiplication, division is Knuth's algorithm D and gcd is
+	 * Lehmer's algorithm. Results that fit into a long again are demoted.
+	 */
+	class big_integer
+	{
+		public:
+			big_integer(long value = 0) : m_small(value) {}
+			big_integer(int value) : m_small(value) {}
+			big_integer(__int128 value);
+			/**
+			 * Parses an optional sign followed by decimal digits.
+			 * Throws std::invalid_argument for anything else.
+			 */
+			explicit big_integer(std::string_view decimal);
+
+			bool is_small() const { return m_limbs.empty(); }
+			/**
+			 * The value, if is_small().
+			 */
+			long to_long() const { return m_small; }
+			int sign() const { return is_small() ? (m_small > 0) - (m_small < 0) : (m_negative ? -1 : 1); }
+			bool is_zero() const { return is_small() && m_small == 0; }
+			/**
+			 * Number of bits of the absolute value.
+			 */
+			int bit_length() const;
+
+			explicit operator double() const;
+			std::string to_string() const;
+
+			friend big_integer operator+(const big_integer& a, const big_integer& b)
+			{
+				long r;
+				if(a.is_small() && b.is_small() && !__builtin_add_overflow(a.m_small, b.m_small, &r))
+					return r;
+				return add(a, b, false);
+			}
+			friend big_integer operator-(const big_integer& a, const big_integer& b)
+			{
+				long r;
+				if(a.is_small() && b.is_small() && !__builtin_sub_overflow(a.m_small, b.m_small, &r))
+					return r;
+				return add(a, b, true);
+			}
+			friend big_integer operator*(const big_integer& a, const big_integer& b)
+			{
+				long r;
+				if(a.is_small() && b.is_small() && !__builtin_mul_overflow(a.m_small, b.m_small, &r))
+					return r;
+				return multiply(a, b);
+			}
+			/**
+			 * Truncating division like for built-in integers.
+			 * Throws std::domain_error on division by zero.
+			 */
+			friend big_integer operator/(const big_integer& a, const big_integer& b)
+			{
+				if(a.is_small() && b.is_small() && b.m_small != 0 && b.m_small != -1)
+					return a.m_small / b.m_small;
+				big_integer q, r;
+				divide(a, b, q, r);
+				return q;
+			}
+			friend big_integer operator%(const big_integer& a, const big_integer& b)
+			{
+				if(a.is_small() && b.is_small() && b.m_small != 0 && b.m_small != -1)
+					return a.m_small % b.m_small;
+				big_integer q, r;
+				divide(a, b, q, r);
+				return r;
+			}
+			big_integer operator-() const
+			{
+				if(is_small() && m_small != std::numeric_limits<long>::min())
+					return -m_small;
+				return big_integer(0) - *this;
+			}
+
+			big_integer& operator+=(const big_integer& other) { return *this = *this + other; }
+			big_integer& operator-=(const big_integer& other) { return *this = *this - other; }
+			big_integer& operator*=(const big_integer& other) { return *this = *this * other; }
+			big_integer& operator/=(const big_integer& other) { return *this = *this / other; }
+			big_integer& operator%=(const big_integer& other) { return *this = *this % other; }
+
+			friend bool operator==(const big_integer& a, const big_integer& b)
+			{
+				if(a.is_small() || b.is_small())
+					return a.is_small() && b.is_small() && a.m_small == b.m_small;
+				return a.m_negative == b.m_negative && a.m_limbs == b.m_limbs;
+			}
+			friend std::strong_ordering operator<=>(const big_integer& a, const big_integer& b)
+			{
+				if(a.is_small() && b.is_small())
+					return a.m_small <=> b.m_small;
+				return compare(a, b);
+			}
+
+			/**
+			 * Computes q and r with a = q*b + r, truncating like built-in integers.
+			 * Throws std::domain_error if b is zero.
+			 */
+			static void divide(const big_integer& a, const big_integer& b, big_integer& q, big_integer& r);
+
+			/**
+			 * The non-negative greatest common divisor.
+			 */
+			friend big_integer gcd(const big_integer& a, const big_integer& b)
+			{
+				if(a.is_small() && b.is_small() && a.m_small != std::numeric_limits<long>::min() && b.m_small != std::numeric_limits<long>::min())
+					return std::gcd(a.m_small, b.m_small);
+				return lehmer_gcd(a, b);
+			}
+		private:
+			long m_small;
+			bool m_negative = false;
+			/**
+			 * Magnitude of values that do not fit into a long, least significant limb first.
+			 */
+			std::vector<unsigned long> m_limbs;
+
+			static big_integer add(const big_integer& a, const big_integer& b, bool subtract);
+			static big_integer multiply(const big_integer& a, const big_integer& b);
+			static std::strong_ordering compare(const big_integer& a, const big_integer& b);
+			static big_integer lehmer_gcd(big_integer a, big_integer b);
+
+			std::vector<unsigned long> magnitude() const;
+			static big_integer from_magnitude(std::vector<unsigned long> magnitude, bool negative);
+	};
+
+	big_integer gcd(const big_integer& a, const big_integer& b);
+	void render(render_buffer& buffer, const big_integer& value);
+	std::ostream& operator<<(std::ostream& out, const big_integer& value);
+}
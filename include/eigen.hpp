@@ -0,0 +1,36 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "types.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace unimath
+{
+	struct eigen_result
+	{
+		/**
+		 * The eigenvalues sorted by real part and then by imaginary part,
+		 * with eigenvalues of multiplicity m appearing m times.
+		 */
+		std::vector<C> values;
+		/**
+		 * The normalized eigenvectors as columns, in the order of the eigenvalues.
+		 * Only present if they were requested.
+		 */
+		std::optional<matrix<C>> vectors;
+	};
+
+	/**
+	 * Computes the eigenvalues (and optionally the eigenvectors) of a square matrix.
+	 * The matrix is reduced to Hessenberg form with Householder reflections,
+	 * and the eigenvalues are found by implicitly shifted QR iterations with
+	 * Wilkinson shifts and deflation.
+	 * Eigenvectors are computed by inverse iteration on the Hessenberg matrix
+	 * and transformed back, so each one only costs O(n^2).
+	 * Throws std::runtime_error if the QR iteration does not converge.
+	 */
+	eigen_result eigen(const matrix<R>& a, bool vectors = false);
+	eigen_result eigen(const matrix<C>& a, bool vectors = false);
+}
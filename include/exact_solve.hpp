@@ -0,0 +1,23 @@
+#pragma once
+
+#include "fraction.hpp"
+#include "matrix.hpp"
+
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Solves A*x = b exactly for a regular rational matrix A.
+	 * A is factorized once in double precision. The solution is then refined
+	 * with residuals computed exactly in integer arithmetic, gaining about
+	 * 20 bits per step, until continued fraction rounding reconstructs a
+	 * rational solution that satisfies the system exactly. The residuals and
+	 * the reconstruction use big_integer, so only the solution itself has to
+	 * fit into fraction.
+	 * Throws std::logic_error if A is singular or too ill-conditioned for
+	 * double precision and std::overflow_error if the solution does not fit
+	 * into fraction.
+	 */
+	std::vector<fraction> exact_solve(const matrix<fraction>& a, const std::vector<fraction>& b);
+}
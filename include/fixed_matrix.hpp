@@ -0,0 +1,324 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <array>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace unimath
+{
+	/**
+	 * A matrix with dimensions known at compile time and storage on the stack.
+	 * Meant for small dense blocks (rotations, transfer blocks, ...) where
+	 * the heap allocations of matrix would dominate.
+	 * Mismatching dimensions are compile errors instead of exceptions, and all
+	 * operations are constexpr, so they can also run at compile time.
+	 */
+	template<typename K, int R, int C>
+	class fixed_matrix
+	{
+		static_assert(R > 0 && C > 0, "fixed_matrix needs at least one row and one column");
+
+		public:
+			using value_type = K;
+
+			constexpr fixed_matrix() : m_entries{}
+			{
+			}
+
+			constexpr fixed_matrix(const K (&entries)[R][C]) : m_entries{}
+			{
+				unroll([&](auto ij){
+					constexpr int i = decltype(ij)::value / C;
+					constexpr int j = decltype(ij)::value % C;
+					m_entries[i*C+j] = entries[i][j];
+				}, std::make_index_sequence<R*C>{});
+			}
+
+			/**
+			 * Copies a matrix. Throws std::logic_error if the dimensions do not match.
+			 */
+			explicit fixed_matrix(const matrix<K>& m) : m_entries{}
+			{
+				if(m.rows() != R || m.columns() != C)
+					throw std::logic_error("matrix dimensions do not match");
+				for(int i=0; i<R; i++)
+					for(int j=0; j<C; j++)
+						m_entries[i*C+j] = m(i, j);
+			}
+
+			static constexpr fixed_matrix identity() requires (R == C)
+			{
+				fixed_matrix m;
+				for(int i=0; i<R; i++)
+					m(i, i) = K(1);
+				return m;
+			}
+
+			constexpr int rows() const { return R; }
+			constexpr int columns() const { return C; }
+
+			constexpr K& operator()(int row, int column) { return m_entries[row*C+column]; }
+			constexpr const K& operator()(int row, int column) const { return m_entries[row*C+column]; }
+
+			constexpr bool operator==(const fixed_matrix& other) const = default;
+
+			constexpr fixed_matrix operator+(const fixed_matrix& other) const
+			{
+				return map(other, std::plus<>());
+			}
+			constexpr fixed_matrix operator-(const fixed_matrix& other) const
+			{
+				return map(other, std::minus<>());
+			}
+			constexpr fixed_matrix operator-() const
+			{
+				fixed_matrix result;
+				unroll([&](auto i){ result.m_entries[i] = -m_entries[i]; }, std::make_index_sequence<R*C>{});
+				return result;
+			}
+			constexpr fixed_matrix operator*(const K& c) const
+			{
+				fixed_matrix result;
+				unroll([&](auto i){ result.m_entries[i] = m_entries[i] * c; }, std::make_index_sequence<R*C>{});
+				return result;
+			}
+
+			template<int N>
+			constexpr fixed_matrix<K, R, N> operator*(const fixed_matrix<K, C, N>& other) const
+			{
+				fixed_matrix<K, R, N> result;
+				unroll([&](auto ij){
+					constexpr int i = decltype(ij)::value / N;
+					constexpr int j = decltype(ij)::value % N;
+					K sum = K(0);
+					unroll([&](auto k){ sum += (*this)(i, k) * other(k, j); }, std::make_index_sequence<C>{});
+					result(i, j) = sum;
+				}, std::make_index_sequence<R*N>{});
+				return result;
+			}
+
+			constexpr std::array<K, R> operator*(const std::array<K, C>& v) const
+			{
+				std::array<K, R> result{};
+				unroll([&](auto i){
+					K sum = K(0);
+					unroll([&](auto k){ sum += (*this)(i, k) * v[k]; }, std::make_index_sequence<C>{});
+					result[i] = sum;
+				}, std::make_index_sequence<R>{});
+				return result;
+			}
+
+			constexpr fixed_matrix<K, C, R> transpose() const
+			{
+				fixed_matrix<K, C, R> result;
+				for(int i=0; i<R; i++)
+					for(int j=0; j<C; j++)
+						result(j, i) = (*this)(i, j);
+				return result;
+			}
+
+			constexpr K determinant() const requires (R == C)
+			{
+				const fixed_matrix& a = *this;
+				if constexpr (R == 1)
+					return a(0, 0);
+				else if constexpr (R == 2)
+					return a(0, 0)*a(1, 1) - a(0, 1)*a(1, 0);
+				else if constexpr (R == 3)
+					return a(0, 0)*(a(1, 1)*a(2, 2) - a(1, 2)*a(2, 1))
+						 - a(0, 1)*(a(1, 0)*a(2, 2) - a(1, 2)*a(2, 0))
+						 + a(0, 2)*(a(1, 0)*a(2, 1) - a(1, 1)*a(2, 0));
+				else
+				{
+					fixed_matrix work = a;
+					K det = K(1);
+					for(int c=0; c<R; c++)
+					{
+						int p = work.pivot(c);
+						if(work(p, c) == K(0))
+							return K(0);
+						if(p != c)
+						{
+							work.swap_rows(p, c);
+							det = -det;
+						}
+						det *= work(c, c);
+						for(int i=c+1; i<R; i++)
+						{
+							K f = work(i, c) / work(c, c);
+							for(int j=c+1; j<R; j++)
+								work(i, j) -= f * work(c, j);
+						}
+					}
+					return det;
+				}
+			}
+
+			/**
+			 * Throws std::logic_error if the matrix is singular.
+			 */
+			constexpr fixed_matrix inverse() const requires (R == C)
+			{
+				const fixed_matrix& a = *this;
+				if constexpr (R <= 3)
+				{
+					K det = determinant();
+					if(det == K(0))
+						throw std::logic_error("matrix is not invertible");
+
+					fixed_matrix adj;
+					if constexpr (R == 1)
+						adj(0, 0) = K(1);
+					else if constexpr (R == 2)
+					{
+						adj(0, 0) = a(1, 1);  adj(0, 1) = -a(0, 1);
+						adj(1, 0) = -a(1, 0); adj(1, 1) = a(0, 0);
+					}
+					else
+					{
+						adj(0, 0) = a(1, 1)*a(2, 2) - a(1, 2)*a(2, 1);
+						adj(0, 1) = a(0, 2)*a(2, 1) - a(0, 1)*a(2, 2);
+						adj(0, 2) = a(0, 1)*a(1, 2) - a(0, 2)*a(1, 1);
+						adj(1, 0) = a(1, 2)*a(2, 0) - a(1, 0)*a(2, 2);
+						adj(1, 1) = a(0, 0)*a(2, 2) - a(0, 2)*a(2, 0);
+						adj(1, 2) = a(0, 2)*a(1, 0) - a(0, 0)*a(1, 2);
+						adj(2, 0) = a(1, 0)*a(2, 1) - a(1, 1)*a(2, 0);
+						adj(2, 1) = a(0, 1)*a(2, 0) - a(0, 0)*a(2, 1);
+						adj(2, 2) = a(0, 0)*a(1, 1) - a(0, 1)*a(1, 0);
+					}
+					return adj * (K(1)/det);
+				}
+				else
+				{
+					fixed_matrix work = a;
+					fixed_matrix result = identity();
+					for(int c=0; c<R; c++)
+					{
+						int p = work.pivot(c);
+						if(work(p, c) == K(0))
+							throw std::logic_error("matrix is not invertible");
+						work.swap_rows(p, c);
+						result.swap_rows(p, c);
+
+						K f = K(1) / work(c, c);
+						for(int j=0; j<R; j++)
+						{
+							work(c, j) *= f;
+							result(c, j) *= f;
+						}
+						for(int i=0; i<R; i++)
+						{
+							if(i == c || work(i, c) == K(0))
+								continue;
+							K g = work(i, c);
+							for(int j=0; j<R; j++)
+							{
+								work(i, j) -= g * work(c, j);
+								result(i, j) -= g * result(c, j);
+							}
+						}
+					}
+					return result;
+				}
+			}
+
+			/**
+			 * Solves A*x = b by Gaussian elimination without forming the inverse.
+			 * Throws std::logic_error if the matrix is singular.
+			 */
+			constexpr std::array<K, R> solve(std::array<K, R> b) const requires (R == C)
+			{
+				fixed_matrix work = *this;
+				for(int c=0; c<R; c++)
+				{
+					int p = work.pivot(c);
+					if(work(p, c) == K(0))
+						throw std::logic_error("matrix is not invertible");
+					if(p != c)
+					{
+						work.swap_rows(p, c);
+						std::swap(b[p], b[c]);
+					}
+					for(int i=c+1; i<R; i++)
+					{
+						K f = work(i, c) / work(c, c);
+						for(int j=c+1; j<R; j++)
+							work(i, j) -= f * work(c, j);
+						b[i] -= f * b[c];
+					}
+				}
+				for(int i=R-1; i>=0; i--)
+				{
+					for(int j=i+1; j<R; j++)
+						b[i] -= work(i, j) * b[j];
+					b[i] /= work(i, i);
+				}
+				return b;
+			}
+		private:
+			std::array<K, R*C> m_entries;
+
+			template<typename, int, int>
+			friend class fixed_matrix;
+
+			template<class F, std::size_t... I>
+			static constexpr void unroll(F&& f, std::index_sequence<I...>)
+			{
+				(f(std::integral_constant<std::size_t, I>{}), ...);
+			}
+
+			template<class BinaryOperation>
+			constexpr fixed_matrix map(const fixed_matrix& other, BinaryOperation function) const
+			{
+				fixed_matrix result;
+				unroll([&](auto i){ result.m_entries[i] = function(m_entries[i], other.m_entries[i]); }, std::make_index_sequence<R*C>{});
+				return result;
+			}
+
+			/**
+			 * Magnitude used to choose pivots: the absolute value for real numbers,
+			 * the squared absolute value for complex numbers and 0/1 for everything else
+			 * (exact types like fraction do not need partial pivoting).
+			 */
+			static constexpr auto magnitude(const K& k)
+			{
+				if constexpr (std::is_arithmetic_v<K>)
+					return k < K(0) ? -k : k;
+				else if constexpr (requires { k.real(); k.imag(); })
+					return k.real()*k.real() + k.imag()*k.imag();
+				else
+					return k == K(0) ? 0 : 1;
+			}
+
+			constexpr int pivot(int c) const
+			{
+				int p = c;
+				for(int i=c+1; i<R; i++)
+					if(magnitude((*this)(i, c)) > magnitude((*this)(p, c)))
+						p = i;
+				return p;
+			}
+
+			constexpr void swap_rows(int a, int b)
+			{
+				if(a == b)
+					return;
+				for(int j=0; j<C; j++)
+					std::swap((*this)(a, j), (*this)(b, j));
+			}
+	};
+
+	template<typename K, int R, int C>
+	inline constexpr bool lazy_matrix_operators<fixed_matrix<K, R, C>> = false;
+
+	template<typename K, int R, int C>
+	std::ostream& operator<<(std::ostream& out, const fixed_matrix<K, R, C>& m)
+	{
+		return out << matrix<K>(m);
+	}
+}
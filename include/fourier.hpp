@@ -41,4 +41,11 @@ namespace unimath
 
 	ctri_polynom cfourier(std::function<std::complex<double>(double)> function, double t, int n);
 	ctri_polynom cpfourier(std::function<std::complex<double>(double)> function, double t, int n);
+
+	/**
+	 * Discrete Fourier transform X_j = sum_k x_k e^(-2 pi i jk/n) by the radix-2 FFT.
+	 * The inverse transform uses e^(+2 pi i jk/n) and divides by n.
+	 * Throws std::logic_error unless the size of x is a power of two.
+	 */
+	std::vector<std::complex<double>> fft(std::vector<std::complex<double>> x, bool inverse = false);
 }
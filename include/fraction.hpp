@@ -1,37 +1,416 @@
 #pragma once
 
+#include "accumulator.hpp"
+
+#include <algorithm>
+#include <compare>
+#include <limits>
 #include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace unimath
 {
+	class render_buffer;
+
+	/**
+	 * What fraction arithmetic does when a reduced result does not fit into a long.
+	 * raise throws std::overflow_error. saturate clamps values beyond the range of
+	 * long to the largest representable magnitude and rounds results with too
+	 * large denominators to a nearby fraction that fits.
+	 * During constant evaluation an overflow is always a compile error.
+	 */
+	enum class fraction_overflow
+	{
+		raise,
+		saturate
+	};
+
+	constexpr unsigned __int128 fraction_abs(__int128 a)
+	{
+		return a < 0 ? -(unsigned __int128)a : (unsigned __int128)a;
+	}
+
+	constexpr unsigned long fraction_gcd64(unsigned long a, unsigned long b)
+	{
+		if(a == 0 || b == 0)
+			return a | b;
+		int shift = __builtin_ctzl(a | b);
+		a >>= __builtin_ctzl(a);
+		do
+		{
+			b >>= __builtin_ctzl(b);
+			if(a > b)
+				std::swap(a, b);
+			b -= a;
+		}
+		while(b != 0);
+		return a << shift;
+	}
+
+	constexpr int fraction_ctz(unsigned __int128 a)
+	{
+		unsigned long low = a;
+		return low ? __builtin_ctzl(low) : 64 + __builtin_ctzl((unsigned long)(a >> 64));
+	}
+
+	/**
+	 * Binary gcd (Stein): only shifts and subtractions, which are much cheaper
+	 * than the library calls behind 128 bit divisions.
+	 */
+	constexpr unsigned __int128 fraction_gcd(unsigned __int128 a, unsigned __int128 b)
+	{
+		if(a == 0 || b == 0)
+			return a | b;
+		if((a | b) >> 64 == 0)
+			return fraction_gcd64(a, b);
+		int shift = fraction_ctz(a | b);
+		a >>= fraction_ctz(a);
+		do
+		{
+			b >>= fraction_ctz(b);
+			if(a > b)
+				std::swap(a, b);
+			b -= a;
+			if((a | b) >> 64 == 0)
+				return (unsigned __int128)fraction_gcd64(a, b) << shift;
+		}
+		while(b != 0);
+		return a << shift;
+	}
+
+	/**
+	 * With d = gcd(q1, q2) the sum p1/q1 + p2/q2 is t/(q1/d * q2) for
+	 * t = p1*(q2/d) + p2*(q1/d), and only gcd(t, d) can still cancel.
+	 * All products stay below 2^127.
+	 */
+	constexpr void fraction_sum(long p1, long q1, __int128 p2, long q2, __int128& p, __int128& q)
+	{
+		long d = fraction_gcd64(q1, q2);
+		if(d == 1)
+		{
+			p = (__int128)p1 * q2 + p2 * q1;
+			q = (__int128)q1 * q2;
+			return;
+		}
+		long s = q1 / d;
+		__int128 t = (__int128)p1 * (q2 / d) + p2 * s;
+		long e = fraction_gcd64(fraction_abs(t % d), d);
+		p = t / e;
+		q = (__int128)s * (q2 / e);
+	}
+
+	/**
+	 * Rational number with long numerator and denominator.
+	 * Intermediate results are computed with 128 bit integers after cancelling
+	 * common factors (TAOCP 4.5.1), so any operation whose reduced result fits
+	 * into a long is exact. Other results are handled by the overflow policy.
+	 * The arithmetic is constexpr, so tables of fractions can be computed at
+	 * compile time.
+	 */
 	class fraction
 	{
 		public:
-			fraction(int p = 0, int q = 1);
-			fraction(long p, long q);
-			fraction(float f);
+			constexpr fraction(int p = 0, int q = 1) : m_p(0), m_q(1)
+			{
+				assign(p, q);
+			}
+			constexpr fraction(long p, long q) : m_p(0), m_q(1)
+			{
+				assign(p, q);
+			}
+			/**
+			 * The first convergent of the continued fraction of f that converts
+			 * back to f, e.g. 1/10 for 0.1 and 1/3 for 1.0/3.
+			 * Throws std::domain_error if f is not finite.
+			 */
+			fraction(double f);
+
+			/**
+			 * The exact binary value of f.
+			 */
+			static fraction exact(double f);
+			/**
+			 * The fraction closest to f with a denominator of at most max_denominator.
+			 */
+			static fraction approximate(double f, long max_denominator);
+			/**
+			 * The fraction closest to p/q (q > 0) with a denominator of at most max_denominator.
+			 */
+			static fraction approximate(__int128 p, __int128 q, long max_denominator);
+
+			constexpr bool operator==(const fraction other) const
+			{
+				return m_p == other.m_p && m_q == other.m_q;
+			}
+			constexpr std::strong_ordering operator<=>(const fraction other) const
+			{
+				if(m_q == other.m_q)
+					return m_p <=> other.m_p;
+				return (__int128)m_p * other.m_q <=> (__int128)other.m_p * m_q;
+			}
+
+			constexpr fraction operator+(const fraction other) const
+			{
+				fraction result = *this;
+				return result += other;
+			}
+			constexpr fraction operator-(const fraction other) const
+			{
+				fraction result = *this;
+				return result -= other;
+			}
+			constexpr fraction operator*(const fraction other) const
+			{
+				fraction result = *this;
+				return result *= other;
+			}
+			constexpr fraction operator/(const fraction other) const
+			{
+				fraction result = *this;
+				return result /= other;
+			}
 
-			bool operator==(const fraction other) const;
-			std::strong_ordering operator<=>(const fraction other) const;
+			constexpr fraction& operator+=(const fraction other)
+			{
+				long sum;
+				if(m_q == 1 && other.m_q == 1 && !__builtin_add_overflow(m_p, other.m_p, &sum))
+				{
+					m_p = sum;
+					return *this;
+				}
+				__int128 p, q;
+				fraction_sum(m_p, m_q, other.m_p, other.m_q, p, q);
+				store(p, q);
+				return *this;
+			}
+			constexpr fraction& operator-=(const fraction other)
+			{
+				long sum;
+				if(m_q == 1 && other.m_q == 1 && !__builtin_sub_overflow(m_p, other.m_p, &sum))
+				{
+					m_p = sum;
+					return *this;
+				}
+				__int128 p, q;
+				fraction_sum(m_p, m_q, -(__int128)other.m_p, other.m_q, p, q);
+				store(p, q);
+				return *this;
+			}
+			/**
+			 * Cancels p1 against q2 and p2 against q1 first, so the product is already reduced.
+			 */
+			constexpr fraction& operator*=(const fraction other)
+			{
+				long g1 = fraction_gcd64(fraction_abs(m_p), other.m_q);
+				long g2 = fraction_gcd64(fraction_abs(other.m_p), m_q);
+				long p1 = m_p / g1, p2 = other.m_p / g2;
+				long q1 = m_q / g2, q2 = other.m_q / g1;
+				long p, q;
+				if(__builtin_mul_overflow(p1, p2, &p) || __builtin_mul_overflow(q1, q2, &q))
+					store((__int128)p1 * p2, (__int128)q1 * q2);
+				else
+					store(p, q);
+				return *this;
+			}
+			constexpr fraction& operator/=(const fraction other)
+			{
+				if(other.m_p == 0)
+					throw std::domain_error("fraction: division by zero");
+				__int128 g1 = fraction_gcd(fraction_abs(m_p), fraction_abs(other.m_p));
+				long g2 = fraction_gcd64(m_q, other.m_q);
+				__int128 p = m_p / g1 * (other.m_q / g2);
+				__int128 q = m_q / g2 * (other.m_p / g1);
+				if(q < 0)
+				{
+					p = -p;
+					q = -q;
+				}
+				store(p, q);
+				return *this;
+			}
 
-			fraction operator+(const fraction other) const;
-			fraction operator-(const fraction other) const;
-			fraction operator*(const fraction other) const;
-			fraction operator/(const fraction other) const;
+			constexpr fraction operator-() const
+			{
+				fraction result = *this;
+				result.store(-(__int128)m_p, m_q);
+				return result;
+			}
 
-			fraction& operator+=(const fraction other);
-			fraction& operator-=(const fraction other);
-			fraction& operator*=(const fraction other);
-			fraction& operator/=(const fraction other);
+			constexpr long numerator() const { return m_p; }
+			constexpr long denominator() const { return m_q; }
 
-			fraction operator-() const;
+			constexpr explicit operator double() const
+			{
+				return (double)m_p / (double)m_q;
+			}
+
+			/**
+			 * The policy is shared by all threads, so it also applies to parallel matrix kernels.
+			 */
+			static void overflow_policy(fraction_overflow policy);
+			static fraction_overflow overflow_policy();
 		protected:
-			void clean();
+			constexpr void clean()
+			{
+				assign(m_p, m_q);
+			}
 		private:
 			long m_p;
 			long m_q;
 
-			friend std::ostream& operator<<(std::ostream&, const fraction);
+			/**
+			 * Reduces p/q and stores it if it fits, otherwise applies the overflow policy.
+			 */
+			constexpr void assign(__int128 p, __int128 q)
+			{
+				if(q == 0)
+					throw std::domain_error("fraction: zero denominator");
+				if(q < 0)
+				{
+					p = -p;
+					q = -q;
+				}
+				if(q != 1)
+				{
+					__int128 g = fraction_gcd(fraction_abs(p), q);
+					p /= g;
+					q /= g;
+				}
+				store(p, q);
+			}
+			/**
+			 * Like assign for p/q that is already reduced with q > 0.
+			 */
+			constexpr void store(__int128 p, __int128 q)
+			{
+				if(p == 0)
+				{
+					m_p = 0;
+					m_q = 1;
+					return;
+				}
+				if(p >= std::numeric_limits<long>::min() && p <= std::numeric_limits<long>::max() && q <= std::numeric_limits<long>::max())
+				{
+					m_p = p;
+					m_q = q;
+					return;
+				}
+				if(std::is_constant_evaluated())
+					throw std::overflow_error("fraction: result does not fit into long");
+				overflow(p, q);
+			}
+			/**
+			 * Applies the overflow policy to a reduced p/q that does not fit.
+			 */
+			void overflow(__int128 p, __int128 q);
+
+			friend class fraction_accumulator;
+			friend void render(render_buffer&, const fraction&);
+	};
+
+	/**
+	 * Sum of fractions that is only reduced when it has to be.
+	 * Terms are added with 128 bit numerator and denominator and no gcd as long
+	 * as nothing overflows; only then both sides are reduced with the binary gcd.
+	 * Summing n products of small fractions this way needs a handful of gcds
+	 * instead of 2n.
+	 */
+	class fraction_accumulator
+	{
+		public:
+			constexpr fraction_accumulator() : m_p(0), m_q(1) {}
+
+			/**
+			 * sum += a*b
+			 */
+			constexpr void add_product(const fraction& a, const fraction& b)
+			{
+				add((__int128)a.m_p * b.m_p, (__int128)a.m_q * b.m_q);
+			}
+			constexpr fraction_accumulator& operator+=(const fraction& f)
+			{
+				add(f.m_p, f.m_q);
+				return *this;
+			}
+
+			/**
+			 * The reduced sum. Applies the overflow policy of fraction if it does not fit.
+			 */
+			constexpr fraction value() const
+			{
+				fraction result;
+				result.assign(m_p, m_q);
+				return result;
+			}
+		private:
+			__int128 m_p;
+			__int128 m_q;
+
+			constexpr void add(__int128 p, __int128 q)
+			{
+				__int128 a, b;
+				if(q == m_q)
+				{
+					if(!__builtin_add_overflow(m_p, p, &a))
+					{
+						m_p = a;
+						return;
+					}
+				}
+				else if(!__builtin_mul_overflow(m_p, q, &a) && !__builtin_mul_overflow(p, m_q, &b) &&
+				        !__builtin_add_overflow(a, b, &a) && !__builtin_mul_overflow(m_q, q, &b))
+				{
+					m_p = a;
+					m_q = b;
+					return;
+				}
+				add_reduced(p, q);
+			}
+
+			constexpr void add_reduced(__int128 p, __int128 q)
+			{
+				__int128 g = fraction_gcd(fraction_abs(m_p), m_q);
+				m_p /= g;
+				m_q /= g;
+				g = fraction_gcd(fraction_abs(p), q);
+				p /= g;
+				q /= g;
+
+				// exact sum with cross-cancellation, as long as 128 bits suffice
+				__int128 d = fraction_gcd(m_q, q);
+				__int128 s = m_q / d;
+				__int128 t, u;
+				if(!__builtin_mul_overflow(m_p, q / d, &t) && !__builtin_mul_overflow(p, s, &u) && !__builtin_add_overflow(t, u, &t))
+				{
+					__int128 e = fraction_gcd(fraction_abs(t), d);
+					if(!__builtin_mul_overflow(s, q / e, &u))
+					{
+						m_p = t / e;
+						m_q = u;
+						return;
+					}
+				}
+
+				// continue with eager fractions, which apply the overflow policy
+				fraction sum = value();
+				fraction term;
+				term.assign(p, q);
+				sum += term;
+				m_p = sum.m_p;
+				m_q = sum.m_q;
+			}
+	};
+
+	template<>
+	struct accumulator_traits<fraction>
+	{
+		using type = fraction_accumulator;
+
+		static constexpr void add_product(type& sum, const fraction& a, const fraction& b) { sum.add_product(a, b); }
+		static constexpr fraction value(const type& sum) { return sum.value(); }
 	};
+	void render(render_buffer&, const fraction&);
 	std::ostream& operator<<(std::ostream&, const fraction);
-}
\ No newline at end of file
+}
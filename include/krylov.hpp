@@ -0,0 +1,394 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+#include "types.hpp"
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * A linear map given only by its action y = A*x.
+	 * y already has the right size when the operator is called.
+	 */
+	template<typename K>
+	using linear_operator = std::function<void(const std::vector<K>& x, std::vector<K>& y)>;
+
+	/**
+	 * The operator x -> A*x. It refers to a, which must outlive it.
+	 */
+	template<typename K>
+	linear_operator<K> as_operator(const matrix<K>& a)
+	{
+		return [&a](const std::vector<K>& x, std::vector<K>& y){
+			for(int i=0; i<a.rows(); i++)
+			{
+				K sum = K(0);
+				for(int j=0; j<a.columns(); j++)
+					sum += a(i, j) * x[j];
+				y[i] = sum;
+			}
+		};
+	}
+
+	/**
+	 * The operator x -> A*x. It refers to a, which must outlive it.
+	 */
+	template<typename K>
+	linear_operator<K> as_operator(const sparse_matrix<K>& a)
+	{
+		return [&a](const std::vector<K>& x, std::vector<K>& y){
+			a.multiply(x, y);
+		};
+	}
+
+	/**
+	 * Jacobi preconditioner, i.e. division by the diagonal.
+	 */
+	template<typename K>
+	class jacobi_preconditioner
+	{
+		public:
+			jacobi_preconditioner(const matrix<K>& a) : m_inverse_diagonal(a.rows())
+			{
+				for(int i=0; i<a.rows(); i++)
+					set(i, a(i, i));
+			}
+
+			jacobi_preconditioner(const sparse_matrix<K>& a) : m_inverse_diagonal(a.rows())
+			{
+				for(int i=0; i<a.rows(); i++)
+					set(i, a(i, i));
+			}
+
+			void operator()(const std::vector<K>& r, std::vector<K>& z) const
+			{
+				for(int i=0; i<r.size(); i++)
+					z[i] = m_inverse_diagonal[i] * r[i];
+			}
+		private:
+			std::vector<K> m_inverse_diagonal;
+
+			void set(int i, const K& d)
+			{
+				if(d == K(0))
+					throw std::logic_error("jacobi preconditioner needs a nonzero diagonal");
+				m_inverse_diagonal[i] = K(1)/d;
+			}
+	};
+
+	/**
+	 * Incomplete LU factorization without fill-in (ILU(0)):
+	 * L and U have exactly the sparsity pattern of A.
+	 */
+	template<typename K>
+	class ilu0_preconditioner
+	{
+		public:
+			ilu0_preconditioner(const sparse_matrix<K>& a) :
+				m_row_pointers(a.row_pointers()), m_column_indices(a.column_indices()), m_values(a.values()), m_diagonal(a.rows())
+			{
+				if(a.rows() != a.columns())
+					throw std::logic_error("matrix is not quadratic");
+				int n = a.rows();
+
+				for(int i=0; i<n; i++)
+				{
+					m_diagonal[i] = -1;
+					for(int p=m_row_pointers[i]; p<m_row_pointers[i+1]; p++)
+						if(m_column_indices[p] == i)
+							m_diagonal[i] = p;
+					if(m_diagonal[i] < 0)
+						throw std::logic_error("ilu0 preconditioner needs a nonzero diagonal");
+				}
+
+				std::vector<int> position(n, -1);
+				for(int i=0; i<n; i++)
+				{
+					for(int p=m_row_pointers[i]; p<m_row_pointers[i+1]; p++)
+						position[m_column_indices[p]] = p;
+
+					for(int p=m_row_pointers[i]; p<m_diagonal[i]; p++)
+					{
+						int k = m_column_indices[p];
+						if(m_values[m_diagonal[k]] == K(0))
+							throw std::logic_error("ilu0 preconditioner broke down on a zero pivot");
+						K f = m_values[p] /= m_values[m_diagonal[k]];
+						for(int q=m_diagonal[k]+1; q<m_row_pointers[k+1]; q++)
+						{
+							int target = position[m_column_indices[q]];
+							if(target >= 0)
+								m_values[target] -= f * m_values[q];
+						}
+					}
+
+					for(int p=m_row_pointers[i]; p<m_row_pointers[i+1]; p++)
+						position[m_column_indices[p]] = -1;
+				}
+			}
+
+			void operator()(const std::vector<K>& r, std::vector<K>& z) const
+			{
+				int n = m_diagonal.size();
+				for(int i=0; i<n; i++)
+				{
+					K s = r[i];
+					for(int p=m_row_pointers[i]; p<m_diagonal[i]; p++)
+						s -= m_values[p] * z[m_column_indices[p]];
+					z[i] = s;
+				}
+				for(int i=n-1; i>=0; i--)
+				{
+					K s = z[i];
+					for(int p=m_diagonal[i]+1; p<m_row_pointers[i+1]; p++)
+						s -= m_values[p] * z[m_column_indices[p]];
+					z[i] = s / m_values[m_diagonal[i]];
+				}
+			}
+		private:
+			std::vector<int> m_row_pointers;
+			std::vector<int> m_column_indices;
+			std::vector<K> m_values;
+			std::vector<int> m_diagonal;
+	};
+
+	template<typename K>
+	struct krylov_result
+	{
+		std::vector<K> x;
+		/**
+		 * The relative residual ||b - A*x|| / ||b|| after every iteration,
+		 * starting with the one of the initial guess.
+		 */
+		std::vector<double> residuals;
+		int iterations;
+		bool converged;
+	};
+
+	/**
+	 * Inner product x^H*y of the Krylov solvers.
+	 */
+	template<typename K>
+	K krylov_dot(const std::vector<K>& x, const std::vector<K>& y)
+	{
+		K sum = K(0);
+		for(int i=0; i<x.size(); i++)
+			sum += conjugate(x[i]) * y[i];
+		return sum;
+	}
+
+	template<typename K>
+	double krylov_norm(const std::vector<K>& x)
+	{
+		double sum = 0;
+		for(auto& v : x)
+			sum += std::norm(v);
+		return std::sqrt(sum);
+	}
+
+	/**
+	 * Solves A*x = b with the (preconditioned) conjugate gradient method.
+	 * A and the preconditioner must be Hermitian positive definite.
+	 * Stops as soon as the relative residual drops below tolerance.
+	 */
+	template<typename K>
+	krylov_result<K> conjugate_gradient(std::type_identity_t<linear_operator<K>> a, const std::vector<K>& b,
+		std::type_identity_t<linear_operator<K>> preconditioner = {}, double tolerance = 1e-10, int max_iterations = 1000,
+		std::vector<K> x0 = {})
+	{
+		int n = b.size();
+		krylov_result<K> result{x0.empty() ? std::vector<K>(n) : std::move(x0), {}, 0, false};
+		auto& x = result.x;
+
+		double bnorm = krylov_norm(b);
+		if(bnorm == 0)
+			bnorm = 1;
+
+		std::vector<K> r(n), z(n), p(n), ap(n);
+		a(x, ap);
+		for(int i=0; i<n; i++)
+			r[i] = b[i] - ap[i];
+
+		double residual = krylov_norm(r)/bnorm;
+		result.residuals.push_back(residual);
+		if(residual < tolerance)
+		{
+			result.converged = true;
+			return result;
+		}
+
+		if(preconditioner) preconditioner(r, z); else z = r;
+		p = z;
+		K rz = krylov_dot(r, z);
+
+		for(int k=0; k<max_iterations; k++)
+		{
+			a(p, ap);
+			K alpha = rz / krylov_dot(p, ap);
+			for(int i=0; i<n; i++)
+			{
+				x[i] += alpha * p[i];
+				r[i] -= alpha * ap[i];
+			}
+			result.iterations++;
+
+			residual = krylov_norm(r)/bnorm;
+			result.residuals.push_back(residual);
+			if(residual < tolerance)
+			{
+				result.converged = true;
+				break;
+			}
+
+			if(preconditioner) preconditioner(r, z); else z = r;
+			K rz_next = krylov_dot(r, z);
+			K beta = rz_next / rz;
+			rz = rz_next;
+			for(int i=0; i<n; i++)
+				p[i] = z[i] + beta * p[i];
+		}
+		return result;
+	}
+
+	/**
+	 * Solves A*x = b with the restarted GMRES(m) method for general matrices,
+	 * using right preconditioning so the reported residuals are the true ones.
+	 * Stops as soon as the relative residual drops below tolerance.
+	 */
+	template<typename K>
+	krylov_result<K> gmres(std::type_identity_t<linear_operator<K>> a, const std::vector<K>& b,
+		std::type_identity_t<linear_operator<K>> preconditioner = {}, double tolerance = 1e-10, int restart = 30,
+		int max_iterations = 1000, std::vector<K> x0 = {})
+	{
+		int n = b.size();
+		int m = std::max(1, std::min(restart, n));
+		krylov_result<K> result{x0.empty() ? std::vector<K>(n) : std::move(x0), {}, 0, false};
+		auto& x = result.x;
+
+		double bnorm = krylov_norm(b);
+		if(bnorm == 0)
+			bnorm = 1;
+
+		std::vector<std::vector<K>> v(m+1, std::vector<K>(n));
+		std::vector<std::vector<K>> h(m+1, std::vector<K>(m));
+		std::vector<double> cs(m);
+		std::vector<K> sn(m), g(m+1), w(n), z(n);
+
+		auto precondition = [&preconditioner](const std::vector<K>& in, std::vector<K>& out){
+			if(preconditioner) preconditioner(in, out); else out = in;
+		};
+
+		bool first = true;
+		while(true)
+		{
+			a(x, w);
+			for(int i=0; i<n; i++)
+				v[0][i] = b[i] - w[i];
+			double beta = krylov_norm(v[0]);
+			if(first)
+			{
+				result.residuals.push_back(beta/bnorm);
+				first = false;
+			}
+			if(beta/bnorm < tolerance)
+			{
+				result.converged = true;
+				break;
+			}
+			if(result.iterations >= max_iterations)
+				break;
+
+			for(auto& e : v[0]) e /= K(beta);
+			std::fill(g.begin(), g.end(), K(0));
+			g[0] = K(beta);
+
+			int j = 0;
+			for(; j<m && result.iterations<max_iterations; j++)
+			{
+				precondition(v[j], z);
+				a(z, w);
+
+				// modified Gram-Schmidt
+				for(int i=0; i<=j; i++)
+				{
+					h[i][j] = krylov_dot(v[i], w);
+					for(int l=0; l<n; l++)
+						w[l] -= h[i][j] * v[i][l];
+				}
+				double wnorm = krylov_norm(w);
+				h[j+1][j] = K(wnorm);
+				if(wnorm != 0)
+					for(int l=0; l<n; l++)
+						v[j+1][l] = w[l] / K(wnorm);
+
+				// apply the previous rotations and eliminate h[j+1][j] with a new one
+				for(int i=0; i<j; i++)
+				{
+					K t1 = h[i][j], t2 = h[i+1][j];
+					h[i][j] = cs[i]*t1 + sn[i]*t2;
+					h[i+1][j] = -conjugate(sn[i])*t1 + cs[i]*t2;
+				}
+				double ax = std::abs(h[j][j]);
+				double ay = wnorm;
+				if(ay == 0)
+				{
+					cs[j] = 1;
+					sn[j] = K(0);
+				}
+				else if(ax == 0)
+				{
+					cs[j] = 0;
+					sn[j] = K(1);
+				}
+				else
+				{
+					double r = std::hypot(ax, ay);
+					cs[j] = ax/r;
+					sn[j] = (h[j][j]/K(ax)) * K(ay/r);
+				}
+				h[j][j] = cs[j]*h[j][j] + sn[j]*h[j+1][j];
+				h[j+1][j] = K(0);
+				g[j+1] = -conjugate(sn[j])*g[j];
+				g[j] = cs[j]*g[j];
+
+				result.iterations++;
+				double residual = std::abs(g[j+1])/bnorm;
+				result.residuals.push_back(residual);
+				if(residual < tolerance || wnorm == 0)
+				{
+					j++;
+					break;
+				}
+			}
+
+			// x += M * V * y with H*y = g
+			std::vector<K> y(j);
+			for(int i=j-1; i>=0; i--)
+			{
+				K s = g[i];
+				for(int l=i+1; l<j; l++)
+					s -= h[i][l] * y[l];
+				y[i] = s / h[i][i];
+			}
+			std::fill(w.begin(), w.end(), K(0));
+			for(int i=0; i<j; i++)
+				for(int l=0; l<n; l++)
+					w[l] += y[i] * v[i][l];
+			precondition(w, z);
+			for(int l=0; l<n; l++)
+				x[l] += z[l];
+
+			if(result.residuals.back() < tolerance)
+			{
+				result.converged = true;
+				break;
+			}
+		}
+		return result;
+	}
+}
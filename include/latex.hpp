@@ -1,5 +1,6 @@
 #pragma once
 
+#include "render.hpp"
 #include "types.hpp"
 
 #include <complex>
@@ -42,33 +43,6 @@ namespace unimath
 	template<typename T>
 	std::ostream& operator<<(std::ostream& out, const std::complex<T> c)
 	{
-		if(!is_latex(out))
-			return std::operator<<(out, c);
-
-		if(c.imag() == T(0))
-		{
-			out << c.real();
-		}
-		else if(c.real() == T(0))
-		{
-			if(c.imag() == T(1))
-				out << "i";
-			else if(c.imag() == T(-1))
-				out << "-i";
-			else
-				out << c.imag() << "i";
-		}
-		else
-		{
-			out << "(" << c.real();
-			if(c.imag() == T(1))
-				out << " + i";
-			else if(c.imag() == T(-1))
-				out << " - i";
-			else
-				out << (has_leading_minus(c.imag())?" - ":" + ") << strip_leading_minus(c.imag()) << "i";
-			out << ")";
-		}
-		return out;
+		return render_to(out, c);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Dense LU decomposition P*A = L*U with partial pivoting.
+	 * Factorizes once, so the same system can be solved for many right hand sides.
+	 */
+	template<typename K>
+	class lu_decomposition
+	{
+		public:
+			/**
+			 * Throws std::logic_error if the matrix is not quadratic or singular.
+			 */
+			lu_decomposition(const matrix<K>& a) : m_n(a.rows()), m_lu(a.rows()*a.rows()), m_pivots(a.rows()), m_odd(false)
+			{
+				if(a.rows() != a.columns())
+					throw std::logic_error("matrix is not quadratic");
+
+				int n = m_n;
+				for(int i=0; i<n; i++)
+					for(int j=0; j<n; j++)
+						m_lu[i*n+j] = a(i, j);
+
+				for(int k=0; k<n; k++)
+				{
+					int p = k;
+					for(int i=k+1; i<n; i++)
+						if(std::abs(m_lu[i*n+k]) > std::abs(m_lu[p*n+k]))
+							p = i;
+					if(m_lu[p*n+k] == K(0))
+						throw std::logic_error("matrix is singular");
+
+					m_pivots[k] = p;
+					if(p != k)
+					{
+						for(int j=0; j<n; j++)
+							std::swap(m_lu[k*n+j], m_lu[p*n+j]);
+						m_odd = !m_odd;
+					}
+
+					K pivot = m_lu[k*n+k];
+					for(int i=k+1; i<n; i++)
+					{
+						K f = m_lu[i*n+k] /= pivot;
+						if(f == K(0))
+							continue;
+						for(int j=k+1; j<n; j++)
+							m_lu[i*n+j] -= f * m_lu[k*n+j];
+					}
+				}
+			}
+
+			int size() const { return m_n; }
+
+			void solve_in_place(std::vector<K>& b) const
+			{
+				int n = m_n;
+				if(b.size() != n)
+					throw std::logic_error("vector size does not match matrix size");
+
+				for(int k=0; k<n; k++)
+					std::swap(b[k], b[m_pivots[k]]);
+				for(int i=0; i<n; i++)
+				{
+					K s = b[i];
+					for(int j=0; j<i; j++)
+						s -= m_lu[i*n+j] * b[j];
+					b[i] = s;
+				}
+				for(int i=n-1; i>=0; i--)
+				{
+					K s = b[i];
+					for(int j=i+1; j<n; j++)
+						s -= m_lu[i*n+j] * b[j];
+					b[i] = s / m_lu[i*n+i];
+				}
+			}
+
+			std::vector<K> solve(std::vector<K> b) const
+			{
+				solve_in_place(b);
+				return b;
+			}
+
+			/**
+			 * Solves A*X = B for all columns of B at once.
+			 */
+			matrix<K> solve(const matrix<K>& b) const
+			{
+				if(b.rows() != m_n)
+					throw std::logic_error("row count does not match matrix size");
+
+				matrix<K> x = b;
+				std::vector<K> column(m_n);
+				for(int j=0; j<b.columns(); j++)
+				{
+					for(int i=0; i<m_n; i++)
+						column[i] = b(i, j);
+					solve_in_place(column);
+					for(int i=0; i<m_n; i++)
+						x(i, j) = column[i];
+				}
+				return x;
+			}
+
+			K determinant() const
+			{
+				K det = K(1);
+				for(int k=0; k<m_n; k++)
+					det *= m_lu[k*m_n+k];
+				return m_odd ? -det : det;
+			}
+		private:
+			int m_n;
+			std::vector<K> m_lu;
+			std::vector<int> m_pivots;
+			bool m_odd;
+	};
+}
@@ -0,0 +1,388 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * A file mapped into memory with mmap. Pages are only loaded when they are
+	 * touched and can be written back by the kernel at any time, so the file
+	 * can be larger than the available RAM.
+	 * Throws std::runtime_error if the file cannot be created, opened or mapped.
+	 */
+	class mapped_file
+	{
+		public:
+			/**
+			 * Creates (or truncates) the file at path with size bytes, all zero.
+			 */
+			mapped_file(const std::string& path, std::size_t size);
+			/**
+			 * Maps an existing file. Without writable, the file is opened read only
+			 * and data() must not be written to.
+			 */
+			explicit mapped_file(const std::string& path, bool writable = true);
+			~mapped_file();
+
+			mapped_file(const mapped_file&) = delete;
+			mapped_file& operator=(const mapped_file&) = delete;
+
+			char* data() const { return m_data; }
+			std::size_t size() const { return m_size; }
+
+			/**
+			 * Asks the kernel to start reading the given range in the background.
+			 */
+			void prefetch(std::size_t offset, std::size_t length) const;
+			/**
+			 * Writes all modified pages back to the file.
+			 */
+			void sync() const;
+		private:
+			int m_fd;
+			char* m_data;
+			std::size_t m_size;
+
+			void map(const std::string& path, bool writable);
+	};
+
+	/**
+	 * Dense matrix stored in a memory mapped file, for matrices larger than RAM.
+	 * The entries are stored in square tiles of tile x tile entries, so a tile
+	 * is contiguous in the file. The operations below work tile by tile and
+	 * prefetch the next tile while the current one is processed, so they stream
+	 * through the file instead of jumping between pages.
+	 * The entries are stored as raw bytes, so K must be trivially copyable
+	 * (double, std::complex<double> and fraction are).
+	 */
+	template<typename K>
+	class mapped_matrix
+	{
+		static_assert(std::is_trivially_copyable_v<K>, "mapped_matrix needs a trivially copyable element type");
+
+		public:
+			using value_type = K;
+
+			/**
+			 * Edge length of a tile: 64 entries, i.e. 32 KiB for double.
+			 */
+			static constexpr int tile = 64;
+
+			/**
+			 * Creates a rows x columns zero matrix in the file at path.
+			 */
+			mapped_matrix(const std::string& path, int rows, int columns) :
+				m_file(path, header_size + tile_bytes()*tile_count(rows, columns)), m_rows(rows), m_columns(columns)
+			{
+				header& h = *reinterpret_cast<header*>(m_file.data());
+				std::memcpy(h.magic, "UNIMATRX", 8);
+				h.rows = rows;
+				h.columns = columns;
+				h.tile = tile;
+				h.element_size = sizeof(K);
+
+				// a fresh file is all zero bytes, which is not K(0) for every type
+				K zero = K(0);
+				unsigned char bytes[sizeof(K)] = {};
+				if(std::memcmp(&zero, bytes, sizeof(K)) != 0)
+				{
+					K* entries = reinterpret_cast<K*>(m_file.data() + header_size);
+					std::fill(entries, entries + (std::size_t)tile*tile*tile_count(rows, columns), zero);
+				}
+			}
+
+			/**
+			 * Copies a matrix expression into a new file at path.
+			 */
+			template<matrix_expression E>
+			mapped_matrix(const std::string& path, const E& e) : mapped_matrix(path, e.rows(), e.columns())
+			{
+				for(int ti=0; ti<tile_rows(); ti++)
+					for(int tj=0; tj<tile_columns(); tj++)
+						for(int i=ti*tile; i<std::min(m_rows, (ti+1)*tile); i++)
+							for(int j=tj*tile; j<std::min(m_columns, (tj+1)*tile); j++)
+								(*this)(i, j) = e(i, j);
+			}
+
+			/**
+			 * Opens a matrix that was created with the same element type.
+			 * Throws std::runtime_error if the file does not hold such a matrix.
+			 */
+			explicit mapped_matrix(const std::string& path) : m_file(path)
+			{
+				if(m_file.size() < header_size)
+					throw std::runtime_error("mapped_matrix: file is too small");
+				const header& h = *reinterpret_cast<const header*>(m_file.data());
+				if(std::memcmp(h.magic, "UNIMATRX", 8) != 0 || h.tile != tile || h.element_size != sizeof(K))
+					throw std::runtime_error("mapped_matrix: file does not contain a matrix of this type");
+				m_rows = h.rows;
+				m_columns = h.columns;
+				if(m_file.size() < header_size + tile_bytes()*tile_count(m_rows, m_columns))
+					throw std::runtime_error("mapped_matrix: file is truncated");
+			}
+
+			int rows() const { return m_rows; }
+			int columns() const { return m_columns; }
+
+			K& operator()(int row, int column)
+			{
+				return tile_data(row/tile, column/tile)[(row%tile)*tile + column%tile];
+			}
+			const K& operator()(int row, int column) const
+			{
+				return tile_data(row/tile, column/tile)[(row%tile)*tile + column%tile];
+			}
+
+			int tile_rows() const { return (m_rows + tile-1)/tile; }
+			int tile_columns() const { return (m_columns + tile-1)/tile; }
+
+			/**
+			 * Returns the tile x tile entries of a tile, row by row.
+			 * Entries outside of the matrix are padding.
+			 */
+			K* tile_data(int ti, int tj) const
+			{
+				return reinterpret_cast<K*>(m_file.data() + header_size + tile_bytes()*((std::size_t)ti*tile_columns() + tj));
+			}
+
+			void prefetch(int ti, int tj) const
+			{
+				if(ti < tile_rows() && tj < tile_columns())
+					m_file.prefetch(header_size + tile_bytes()*((std::size_t)ti*tile_columns() + tj), tile_bytes());
+			}
+
+			void sync() const { m_file.sync(); }
+
+			/**
+			 * Brings the matrix into row echelon form like matrix::zsf, with the same
+			 * pivots and the same arithmetic, so exact types give identical results.
+			 * Every pivot step streams once through the tiles below the pivot row.
+			 */
+			std::vector<int> zsf()
+			{
+				std::vector<int> pivots;
+				std::vector<K> pivot_row, factors(tile);
+
+				int row = 0;
+				for(int c=0; c<m_columns && row<m_rows; c++)
+				{
+					int r = row;
+					while(r<m_rows && (*this)(r, c) == K(0)) r++;
+					if(r == m_rows)
+						continue;
+					pivots.push_back(c);
+					if(row == m_rows-1)
+						break;
+
+					swap_rows(row, r);
+					copy_row(row, c, pivot_row);
+
+					K pivot = pivot_row[0];
+					for(int ti=row/tile; ti<tile_rows(); ti++)
+					{
+						int first = std::max(row+1, ti*tile);
+						int last = std::min(m_rows, (ti+1)*tile);
+						bool any = false;
+						for(int i=first; i<last; i++)
+						{
+							K sc = (*this)(i, c);
+							factors[i-first] = sc == K(0) ? K(0) : -sc/pivot;
+							any = any || sc != K(0);
+						}
+						if(any)
+							update_rows(first, last, factors, c, pivot_row, ti);
+					}
+					row++;
+				}
+				return pivots;
+			}
+
+			/**
+			 * Brings the matrix into reduced row echelon form like matrix::nzsf.
+			 */
+			std::vector<int> nzsf()
+			{
+				std::vector<int> pivots = zsf();
+				std::vector<K> pivot_row, factors(tile);
+
+				for(int i=0; i<pivots.size(); i++)
+				{
+					int c = pivots[i];
+					if((*this)(i, c) != K(1))
+					{
+						K f = K(1)/(*this)(i, c);
+						for(int j=c; j<m_columns; j++)
+							(*this)(i, j) *= f;
+					}
+					copy_row(i, c, pivot_row);
+
+					for(int ti=0; ti*tile<i; ti++)
+					{
+						int first = ti*tile;
+						int last = std::min(i, (ti+1)*tile);
+						bool any = false;
+						for(int j=first; j<last; j++)
+						{
+							K v = (*this)(j, c);
+							factors[j-first] = -v;
+							any = any || v != K(0);
+						}
+						if(any)
+							update_rows(first, last, factors, c, pivot_row, ti);
+					}
+				}
+				return pivots;
+			}
+		private:
+			struct header
+			{
+				char magic[8];
+				int rows;
+				int columns;
+				int tile;
+				int element_size;
+			};
+			// one page, so that the tiles are page aligned
+			static constexpr std::size_t header_size = 4096;
+
+			mapped_file m_file;
+			int m_rows;
+			int m_columns;
+
+			static constexpr std::size_t tile_bytes() { return (std::size_t)tile*tile*sizeof(K); }
+			static std::size_t tile_count(int rows, int columns)
+			{
+				return (std::size_t)((rows + tile-1)/tile) * ((columns + tile-1)/tile);
+			}
+
+			void swap_rows(int a, int b)
+			{
+				if(a == b)
+					return;
+				for(int j=0; j<m_columns; j++)
+					std::swap((*this)(a, j), (*this)(b, j));
+			}
+
+			void copy_row(int row, int start, std::vector<K>& buffer) const
+			{
+				buffer.resize(m_columns - start);
+				for(int j=start; j<m_columns; j++)
+					buffer[j-start] = (*this)(row, j);
+			}
+
+			/**
+			 * Adds factors[i-first] * pivot_row to the rows first..last-1, which lie in tile row ti,
+			 * from column start on. Rows with a zero factor are skipped like in matrix::zsf.
+			 */
+			void update_rows(int first, int last, const std::vector<K>& factors, int start, const std::vector<K>& pivot_row, int ti)
+			{
+				for(int tj=start/tile; tj<tile_columns(); tj++)
+				{
+					prefetch(ti, tj+1);
+					K* t = tile_data(ti, tj);
+					int from = std::max(start, tj*tile);
+					int to = std::min(m_columns, (tj+1)*tile);
+					for(int i=first; i<last; i++)
+					{
+						const K& f = factors[i-first];
+						if(f == K(0))
+							continue;
+						K* row = t + (i%tile)*tile;
+						for(int j=from; j<to; j++)
+							row[j - tj*tile] += f * pivot_row[j-start];
+					}
+				}
+			}
+	};
+
+	template<typename K>
+	inline constexpr bool lazy_matrix_operators<mapped_matrix<K>> = false;
+
+	/**
+	 * Computes dst = a*b tile by tile, so only three tiles need to be in RAM at a time.
+	 * dst must already have the right size and must not be one of the factors.
+	 */
+	template<typename K>
+	void multiply_into(mapped_matrix<K>& dst, const mapped_matrix<K>& a, const mapped_matrix<K>& b)
+	{
+		constexpr int T = mapped_matrix<K>::tile;
+		if(a.columns() != b.rows())
+			throw std::logic_error("colum count of A does not match row count of B");
+		if(dst.rows() != a.rows() || dst.columns() != b.columns())
+			throw std::logic_error("destination does not have the size of the product");
+		if(&dst == &a || &dst == &b)
+			throw std::logic_error("destination of a product must not be a factor");
+
+		for(int ti=0; ti<dst.tile_rows(); ti++)
+		{
+			int rows = std::min(T, a.rows() - ti*T);
+			for(int tj=0; tj<dst.tile_columns(); tj++)
+			{
+				int columns = std::min(T, b.columns() - tj*T);
+				K* c = dst.tile_data(ti, tj);
+				std::fill(c, c + T*T, K(0));
+
+				for(int tk=0; tk<a.tile_columns(); tk++)
+				{
+					a.prefetch(ti, tk+1);
+					b.prefetch(tk+1, tj);
+					int depth = std::min(T, a.columns() - tk*T);
+					const K* at = a.tile_data(ti, tk);
+					const K* bt = b.tile_data(tk, tj);
+					for(int i=0; i<rows; i++)
+					{
+						for(int k=0; k<depth; k++)
+						{
+							const K& f = at[i*T + k];
+							if(f == K(0))
+								continue;
+							for(int j=0; j<columns; j++)
+								c[i*T + j] += f * bt[k*T + j];
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * Element-wise combination of two mapped matrices into dst, tile by tile.
+	 */
+	template<typename A, typename B, typename C, class BinaryOperation>
+	void binary_transform(const mapped_matrix<A>& m1, const mapped_matrix<B>& m2, const BinaryOperation& function, mapped_matrix<C>& dst)
+	{
+		if(m1.columns() != m2.columns() || m1.columns() != dst.columns())
+			throw std::logic_error("column count does not match");
+		if(m1.rows() != m2.rows() || m1.rows() != dst.rows())
+			throw std::logic_error("row count does not match");
+
+		constexpr int T = mapped_matrix<A>::tile;
+		for(int ti=0; ti<dst.tile_rows(); ti++)
+		{
+			int rows = std::min(T, dst.rows() - ti*T);
+			for(int tj=0; tj<dst.tile_columns(); tj++)
+			{
+				int next_i = tj+1 < dst.tile_columns() ? ti : ti+1;
+				int next_j = tj+1 < dst.tile_columns() ? tj+1 : 0;
+				m1.prefetch(next_i, next_j);
+				m2.prefetch(next_i, next_j);
+
+				int columns = std::min(T, dst.columns() - tj*T);
+				const A* t1 = m1.tile_data(ti, tj);
+				const B* t2 = m2.tile_data(ti, tj);
+				C* t = dst.tile_data(ti, tj);
+				for(int i=0; i<rows; i++)
+					for(int j=0; j<columns; j++)
+						t[i*T + j] = function(t1[i*T + j], t2[i*T + j]);
+			}
+		}
+	}
+}
@@ -1,11 +1,20 @@
 #pragma once
 
+#include "accumulator.hpp"
 #include "latex.hpp"
+#include "render.hpp"
+#include "thread_pool.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <concepts>
 #include <functional>
 #include <iomanip>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
@@ -16,11 +25,73 @@
 
 namespace unimath
 {
+	/**
+	 * Anything that has a size and can be evaluated element by element like a matrix.
+	 * This is satisfied by matrix itself and by the lazy expressions returned by
+	 * its arithmetic operators.
+	 */
+	template<typename E>
+	concept matrix_expression = requires(const E& e)
+	{
+		typename E::value_type;
+		{ e.rows() } -> std::convertible_to<int>;
+		{ e.columns() } -> std::convertible_to<int>;
+		e(0, 0);
+	};
+
+	/**
+	 * Matrix expressions that come with their own arithmetic (like fixed_matrix)
+	 * opt out of the lazy operators below by specializing this to false.
+	 */
+	template<typename E>
+	inline constexpr bool lazy_matrix_operators = true;
+
+	template<typename E>
+	concept lazy_operand = matrix_expression<E> && lazy_matrix_operators<E>;
+
+	template<typename K>
+	class matrix;
+	template<typename K>
+	class product_chain;
+
+	template<typename E>
+	struct is_matrix : std::false_type {};
+	template<typename K>
+	struct is_matrix<matrix<K>> : std::true_type {};
+
 	template<typename K>
 	class matrix
 	{
 		public:
-			matrix(std::vector<std::vector<K>> entries) : m_entries(entries)
+			using value_type = K;
+
+			/**
+			 * Evaluates a matrix expression in a single pass.
+			 */
+			template<matrix_expression E> requires (!std::is_same_v<E, matrix<K>>)
+			matrix(const E& e) : m_rows(e.rows()), m_columns(e.columns()), m_entries(e.rows())
+			{
+				for(int i=0; i<m_rows; i++)
+				{
+					auto& row = m_entries[i];
+					row.reserve(m_columns);
+					for(int j=0; j<m_columns; j++)
+						row.push_back(e(i, j));
+				}
+			}
+
+			matrix(const product_chain<K>& chain) : matrix(chain.evaluate())
+			{
+			}
+
+			/**
+			 * Creates a rows x columns matrix filled with zeros.
+			 */
+			matrix(int rows, int columns) : m_rows(rows), m_columns(columns), m_entries(rows, std::vector<K>(columns))
+			{
+			}
+
+			matrix(std::vector<std::vector<K>> entries) : m_entries(std::move(entries))
 			{
 				m_columns = 0;
 				m_rows = m_entries.size();
@@ -32,91 +103,187 @@ namespace unimath
 
 			static matrix<K> identity(int n)
 			{
-				std::vector<std::vector<K>> entries(n);
+				matrix<K> m(n, n);
 				for(int i=0; i<n; i++)
-				{
-					entries[i].resize(n);
-					entries[i][i] = K(1);
-				}
-				return matrix<K>(entries);
+					m.m_entries[i][i] = K(1);
+				return m;
 			}
 
-			void zsf(int row=0, int col=0, std::ostream* out = nullptr)
+			int rows() const { return m_rows; }
+			int columns() const { return m_columns; }
+
+			K& operator()(int row, int column) { return m_entries[row][column]; }
+			const K& operator()(int row, int column) const { return m_entries[row][column]; }
+
+			/**
+			 * Adds a matrix expression in place, without a temporary.
+			 */
+			template<matrix_expression E>
+			matrix<K>& operator+=(const E& e)
 			{
-				if(row == m_entries.size()-1)
-					return;
-				if(out) *out << *this;
+				return axpy(K(1), e);
+			}
 
-				int c = std::numeric_limits<int>::max();
-				for(int j=row; j<m_entries.size(); j++)
+			template<matrix_expression E>
+			matrix<K>& operator-=(const E& e)
+			{
+				return axpy(K(-1), e);
+			}
+
+			matrix<K>& operator*=(const K& c)
+			{
+				for(auto& row : m_entries)
+					for(auto& v : row)
+						v *= c;
+				return *this;
+			}
+
+			/**
+			 * Replaces the matrix by the product with m from the right.
+			 * Loops that multiply repeatedly should use multiply_into with
+			 * their own buffers instead, this allocates the result.
+			 */
+			matrix<K>& operator*=(const matrix<K>& m)
+			{
+				matrix<K> result(m_rows, m.m_columns);
+				multiply_into(result, *this, m);
+				std::swap(*this, result);
+				return *this;
+			}
+
+			/**
+			 * Fused update this += alpha*x.
+			 */
+			template<matrix_expression E>
+			matrix<K>& axpy(const K& alpha, const E& x)
+			{
+				if(x.rows() != m_rows)
+					throw std::logic_error("row count does not match");
+				if(x.columns() != m_columns)
+					throw std::logic_error("column count does not match");
+
+				for(int i=0; i<m_rows; i++)
 				{
-					auto& row = m_entries[j];
-					for(int i=col; i<std::min((int)row.size(), c); i++)
-						if(row[i] != K(0)) c = i;
+					auto& row = m_entries[i];
+					for(int j=0; j<m_columns; j++)
+						row[j] += alpha * x(i, j);
 				}
-				if(c == std::numeric_limits<int>::max())
-					return;
-				
+				return *this;
+			}
+
+			/**
+			 * Brings the matrix into row echelon form (Zeilenstufenform).
+			 * Works column by column without recursion, so the stack usage does
+			 * not depend on the size of the matrix.
+			 * Returns the pivot column of every nonzero row, i.e. the size of the
+			 * result is the rank of the matrix.
+			 */
+			std::vector<int> zsf(std::ostream* out = nullptr)
+			{
+				std::vector<int> pivots;
+				pivots.reserve(std::min(m_rows, m_columns));
+
+				int row = 0;
+				for(int c=0; c<m_columns && row<m_rows; c++)
 				{
-					int r;
-					for(int i=row; i<m_entries.size(); i++)
-						if(m_entries[i][c] != K(0)) {r = i; break;}
+					int r = row;
+					while(r<m_rows && m_entries[r][c] == K(0)) r++;
+					if(r == m_rows)
+						continue;
+					pivots.push_back(c);
+
+					// the last row has nothing left to eliminate below it
+					if(row == m_rows-1)
+						break;
+
+					if(out) *out << *this;
 					if(r != row)
 					{
 						swap(row, r, out);
 						if(out) *out << *this;
 					}
-				}
 
-				K pivot = m_entries[row][c];
-				for(int i=row+1; i<m_entries.size(); i++)
-				{
-					K sc = m_entries[i][c];
-					K cc = (-sc/pivot);
-					if(cc != K(0))
-					{
-						add(i, cc, row, out);
-						if(out) *out << *this;
-					}
-				}
-				if(out) { if(is_latex(*out)) *out << "\\\\" << std::endl; else *out << std::endl; }
+					K pivot = m_entries[row][c];
+					auto eliminate = [&](int first, int last){
+						for(int i=first; i<last; i++)
+						{
+							K sc = m_entries[i][c];
+							if(sc == K(0))
+								continue;
+							K cc = (-sc/pivot);
+							add(i, cc, row, out, c);
+							if(out) *out << *this;
+						}
+					};
+					update_rows(row+1, m_rows, m_columns-c, out, eliminate);
+					if(out) { if(is_latex(*out)) *out << "\\\\" << std::endl; else *out << std::endl; }
 
-				zsf(row+1, c+1, out);
+					row++;
+				}
+				return pivots;
 			}
 
-			void nzsf(std::ostream* out = nullptr)
+			/**
+			 * Brings the matrix into reduced row echelon form (normierte Zeilenstufenform)
+			 * and returns the pivot columns like zsf().
+			 */
+			std::vector<int> nzsf(std::ostream* out = nullptr)
 			{
-				zsf(0, 0, out);
+				std::vector<int> pivots = zsf(out);
 				if(out) { if(is_latex(*out)) *out << "\\cline{-}" << std::endl; else *out << "--------------------\n" << std::endl; }
 
-				for(int i=0; i<m_entries.size(); i++)
+				for(int i=0; i<pivots.size(); i++)
 				{
 					if(out) *out << *this;
 
-					auto& row = m_entries[i];
-					int c = 0;
-					for(c=0; c<row.size() && row[c] == K(0); c++);
-
-					if(c==row.size() || row[c] == K(0))
-						continue;
-
-					if(row[c] != K(1))
+					int c = pivots[i];
+					if(m_entries[i][c] != K(1))
 					{
-						multiply(i, K(1)/row[c], out);
+						multiply(i, K(1)/m_entries[i][c], out, c);
 						if(out) *out << *this;
 					}
 
-					for(int j=i-1; j>=0; j--)
-					{
-						auto& row2 = m_entries[j];
-						if(row2[c] != K(0))
+					auto eliminate = [&](int first, int last){
+						for(int j=last-1; j>=first; j--)
 						{
-							add(j, -row2[c], i, out);
-							if(out) *out << *this;
+							auto& row2 = m_entries[j];
+							if(row2[c] != K(0))
+							{
+								add(j, -row2[c], i, out, c);
+								if(out) *out << *this;
+							}
 						}
-					}
-					if(out && i!=m_entries.size()-1) { if(is_latex(*out)) *out << "\\\\" << std::endl; else *out << std::endl; }
+					};
+					update_rows(0, i, m_columns-c, out, eliminate);
+					if(out && i!=pivots.size()-1) { if(is_latex(*out)) *out << "\\\\" << std::endl; else *out << std::endl; }
 				}
+				return pivots;
+			}
+
+			/**
+			 * Returns a basis of the null space as the columns of a matrix
+			 * with columns() rows and columns()-rank columns.
+			 */
+			matrix<K> kernel() const
+			{
+				matrix<K> work = *this;
+				std::vector<int> pivots = work.nzsf();
+
+				std::vector<bool> is_pivot(m_columns);
+				for(int c : pivots) is_pivot[c] = true;
+
+				std::vector<std::vector<K>> entries(m_columns, std::vector<K>(m_columns - pivots.size()));
+				int k = 0;
+				for(int f=0; f<m_columns; f++)
+				{
+					if(is_pivot[f])
+						continue;
+					entries[f][k] = K(1);
+					for(int i=0; i<pivots.size(); i++)
+						entries[pivots[i]][k] = -work.m_entries[i][f];
+					k++;
+				}
+				return matrix<K>(entries);
 			}
 
 			matrix<K> inverse(std::ostream* out = nullptr)
@@ -127,46 +294,36 @@ namespace unimath
 				int n = m_rows;
 
 				matrix<K> work = concat(*this, matrix<K>::identity(n));
-				work.nzsf(out);
+				std::vector<int> pivots = work.nzsf(out);
 
-				if(work.rank(n) != n)
+				if(pivots.size() < n || pivots[n-1] != n-1)
 					throw std::logic_error("matrix is not invertible");
 
 				return work.submat(0, n);
 			}
-
-			matrix<K> operator+(const matrix<K> other) const
-			{
-				return binary_transform(*this, other, std::plus<K>());
-			}
-			matrix<K> operator-(const matrix<K> other) const
+			/**
+			 * Elimination steps that update at least this many entries are split
+			 * across thread_pool::shared(). Every row is updated with exactly the
+			 * same operations either way, so the results do not depend on it.
+			 * The threshold may be changed while other threads eliminate.
+			 */
+			static void parallel_threshold(long entries) { m_parallel_threshold = entries; }
+			static long parallel_threshold() { return m_parallel_threshold; }
+		protected:
+			/**
+			 * Runs the row updates eliminate(first, last) for the rows begin..end-1,
+			 * in parallel if the step is large enough and nothing is logged.
+			 */
+			template<class F>
+			static void update_rows(int begin, int end, int width, std::ostream* out, const F& eliminate)
 			{
-				return binary_transform(*this, other, std::minus<K>());
+				long threshold = m_parallel_threshold;
+				if(out || (long)(end-begin)*width < threshold)
+					eliminate(begin, end);
+				else
+					thread_pool::shared().parallel_for(begin, end, eliminate, std::max(1L, threshold/(8L*width)));
 			}
-			matrix<K> operator*(const matrix<K> other) const
-			{
-				if(m_columns != other.m_rows)
-					throw std::logic_error("colum count of A does not match row count of B");
 
-				int r = m_rows;
-				int c = other.m_columns;
-
-				std::vector<std::vector<K>> entries(r);
-				for(int i=0; i<r; i++)
-				{
-					auto& row = entries[i];
-					row.resize(c);
-					for(int j=0; j<c; j++)
-					{
-						K sum = K(0);
-						for(int a=0; a<m_columns; a++)
-							sum += m_entries[i][a] * other.m_entries[a][j];
-						row[j] = sum;
-					}
-				}
-				return matrix<K>(entries);
-			}
-		protected:
 			void swap(int a, int b, std::ostream* out = nullptr)
 			{
 				if(a==b)
@@ -188,12 +345,12 @@ namespace unimath
 				}
 			}
 
-			void add(int a, K c, int b, std::ostream* out = nullptr)
+			void add(int a, K c, int b, std::ostream* out = nullptr, int start = 0)
 			{
 				auto& va = m_entries[a];
 				auto& vb = m_entries[b];
 
-				for(int i=0; i<va.size(); i++)
+				for(int i=start; i<va.size(); i++)
 					va[i] += c * vb[i];
 
 				if(out)
@@ -214,10 +371,10 @@ namespace unimath
 				}
 			}
 
-			void multiply(int a, K c, std::ostream* out = nullptr)
+			void multiply(int a, K c, std::ostream* out = nullptr, int start = 0)
 			{
 				auto& va = m_entries[a];
-				for(int i=0; i<va.size(); i++)
+				for(int i=start; i<va.size(); i++)
 					va[i] *= c;
 
 				if(out)
@@ -238,24 +395,6 @@ namespace unimath
 				}
 			}
 
-			int rank(int cols = 0)
-			{
-				if(cols == 0) cols = m_columns;
-				int rank = 0;
-				for(auto& row : m_entries)
-				{
-					for(int c=0; c<cols; c++)
-					{
-						if(row[c] != K(0))
-						{
-							rank++;
-							break;
-						}
-					}
-				}
-				return rank;
-			}
-
 			matrix<K> submat(int r=0, int c=0, int rr=0, int cc=0)
 			{
 				if(rr==0) rr = m_rows;
@@ -274,10 +413,8 @@ namespace unimath
 			int m_rows;
 			int m_columns;
 			std::vector<std::vector<K>> m_entries;
+			static inline std::atomic<long> m_parallel_threshold = 1 << 15;
 
-			template<typename T>
-			friend std::ostream& operator<<(std::ostream& out, const matrix<T>& matrix);
-			
 			template<typename M, typename N>
 			friend matrix<std::common_type_t<M, N>> concat(matrix<M> m, matrix<N> n);
 			
@@ -309,64 +446,81 @@ namespace unimath
 		return matrix<C>(entries);
 	}
 
+	/**
+	 * Renders a matrix as bmatrix in latex mode and with bracket glyphs otherwise.
+	 * In text mode every entry is formatted once into a scratch buffer, which
+	 * gives the column width, and then copied into place.
+	 */
 	template<typename T>
-	std::ostream& operator<<(std::ostream& out, const matrix<T>& matrix)
-	{			
-		if(is_latex(out))
+	void render(render_buffer& buffer, const matrix<T>& m)
+	{
+		int rows = m.rows();
+		int columns = m.columns();
+
+		if(buffer.latex())
 		{
-			out << "\\begin{bmatrix}";
-			for(int j=0; j<matrix.m_entries.size(); j++)
+			buffer.append("\\begin{bmatrix}");
+			for(int i=0; i<rows; i++)
 			{
-				auto& row = matrix.m_entries[j];
-				for(int i=0; i<row.size(); i++)
+				for(int j=0; j<columns; j++)
 				{
-					out << row[i];
-					if(i != row.size() - 1)
-						out << " & ";
+					render(buffer, m(i, j));
+					if(j != columns-1)
+						buffer.append(" & ");
 				}
-				if(j != matrix.m_entries.size()-1)
-					out << "\\\\";
+				if(i != rows-1)
+					buffer.append("\\\\");
 			}
-			out << "\\end{bmatrix}";
+			buffer.append("\\end{bmatrix}");
+			return;
 		}
-		else
+
+		render_lease cells(buffer.stream());
+		std::vector<int> ends(rows*columns);
+		int len = 0;
+		for(int i=0; i<rows; i++)
 		{
-			int len=0;
-			for(auto& row : matrix.m_entries)
+			for(int j=0; j<columns; j++)
 			{
-				for(auto e : row)
-				{
-					std::ostringstream oss;
-					oss << e;
-					len = std::max(len, (int)oss.tellp());
-				}
+				int begin = cells->size();
+				render(*cells, m(i, j));
+				ends[i*columns+j] = cells->size();
+				len = std::max(len, cells->size() - begin);
 			}
+		}
 
-			for(auto& row : matrix.m_entries)
-			{	
-				if(row == matrix.m_entries.front())
-					out << "⎡ ";
-				else if(row == matrix.m_entries.back())
-					out << "⎣ ";
-				else
-					out << "⎢ ";
-				
-				for(auto e : row)
-				{
-					std::ostringstream oss;
-					oss << e;
-					out << std::setw(len) << oss.str() << " ";
-				}
-
-				if(row == matrix.m_entries.front())
-					out << "⎤" << std::endl;
-				else if(row == matrix.m_entries.back())
-					out << "⎦" << std::endl;
-				else
-					out << "⎥" << std::endl;
+		int begin = 0;
+		for(int i=0; i<rows; i++)
+		{
+			if(i == 0)
+				buffer.append("⎡ ");
+			else if(i == rows-1)
+				buffer.append("⎣ ");
+			else
+				buffer.append("⎢ ");
+
+			for(int j=0; j<columns; j++)
+			{
+				int end = ends[i*columns+j];
+				buffer.pad(len - (end-begin));
+				buffer.append(*cells, begin, end);
+				buffer.append(' ');
+				begin = end;
 			}
+
+			if(i == 0)
+				buffer.append("⎤\n");
+			else if(i == rows-1)
+				buffer.append("⎦\n");
+			else
+				buffer.append("⎥\n");
 		}
-		return out;
+	}
+
+	template<typename T>
+	std::ostream& operator<<(std::ostream& out, const matrix<T>& m)
+	{
+		return render_to(out, m);
 	}
 
 	template<typename M, typename N>
@@ -389,4 +543,297 @@ namespace unimath
 
 		return matrix<X>(entries);
 	}
+
+	/**
+	 * How an operand of a lazy expression is held: lvalue matrices are
+	 * referenced, temporary matrices and nested expressions are stored by value.
+	 */
+	template<typename E>
+	using expression_storage_t = std::conditional_t<std::is_lvalue_reference_v<E> && is_matrix<std::remove_cvref_t<E>>::value,
+		const std::remove_cvref_t<E>&, std::remove_cvref_t<E>>;
+
+	/**
+	 * Lazy element-wise combination of two matrix expressions.
+	 * L and R are the operand types as forwarded to the operator, see
+	 * expression_storage_t, so a chain like a+b-c is evaluated in a single
+	 * pass without temporaries. Like product_chain, an expression that is
+	 * kept (e.g. with auto) must not outlive the lvalue matrices it refers to;
+	 * assign it to a matrix to evaluate it.
+	 */
+	template<typename L, typename R, class BinaryOperation>
+		requires matrix_expression<std::remove_cvref_t<L>> && matrix_expression<std::remove_cvref_t<R>>
+	class binary_expression
+	{
+		public:
+			using value_type = std::invoke_result_t<const BinaryOperation&,
+				typename std::remove_cvref_t<L>::value_type, typename std::remove_cvref_t<R>::value_type>;
+
+			binary_expression(L&& left, R&& right, BinaryOperation function)
+				: m_left(std::forward<L>(left)), m_right(std::forward<R>(right)), m_function(function)
+			{
+				if(m_left.columns() != m_right.columns())
+					throw std::logic_error("column count does not match");
+				if(m_left.rows() != m_right.rows())
+					throw std::logic_error("row count does not match");
+			}
+
+			int rows() const { return m_left.rows(); }
+			int columns() const { return m_left.columns(); }
+
+			value_type operator()(int row, int column) const
+			{
+				return m_function(m_left(row, column), m_right(row, column));
+			}
+		private:
+			expression_storage_t<L> m_left;
+			expression_storage_t<R> m_right;
+			BinaryOperation m_function;
+	};
+
+	template<typename E, class UnaryOperation>
+		requires matrix_expression<std::remove_cvref_t<E>>
+	class unary_expression
+	{
+		public:
+			using value_type = std::invoke_result_t<const UnaryOperation&, typename std::remove_cvref_t<E>::value_type>;
+
+			unary_expression(E&& e, UnaryOperation function) : m_e(std::forward<E>(e)), m_function(function)
+			{
+			}
+
+			int rows() const { return m_e.rows(); }
+			int columns() const { return m_e.columns(); }
+
+			value_type operator()(int row, int column) const
+			{
+				return m_function(m_e(row, column));
+			}
+		private:
+			expression_storage_t<E> m_e;
+			UnaryOperation m_function;
+	};
+
+	template<typename L, typename R>
+		requires lazy_operand<std::remove_cvref_t<L>> && lazy_operand<std::remove_cvref_t<R>>
+	auto operator+(L&& left, R&& right)
+	{
+		return binary_expression<L, R, std::plus<>>(std::forward<L>(left), std::forward<R>(right), {});
+	}
+
+	template<typename L, typename R>
+		requires lazy_operand<std::remove_cvref_t<L>> && lazy_operand<std::remove_cvref_t<R>>
+	auto operator-(L&& left, R&& right)
+	{
+		return binary_expression<L, R, std::minus<>>(std::forward<L>(left), std::forward<R>(right), {});
+	}
+
+	template<typename E>
+		requires lazy_operand<std::remove_cvref_t<E>>
+	auto operator-(E&& e)
+	{
+		return unary_expression<E, std::negate<>>(std::forward<E>(e), {});
+	}
+
+	/**
+	 * Whether multiply_into may skip zero entries of its left factor. Not for
+	 * floating point entries, where 0*NaN and 0*Inf have to give NaN.
+	 */
+	template<typename K>
+	inline constexpr bool skip_zero_factors = !std::is_floating_point_v<K>;
+	template<typename T>
+	inline constexpr bool skip_zero_factors<std::complex<T>> = false;
+
+	/**
+	 * Computes dst = a*b, reusing the storage of dst if it already has the right size.
+	 * dst must not be one of the factors. Zero entries of a are skipped where
+	 * skip_zero_factors allows it.
+	 */
+	template<typename K>
+	void multiply_into(matrix<K>& dst, const matrix<K>& a, const matrix<K>& b)
+	{
+		if(a.columns() != b.rows())
+			throw std::logic_error("colum count of A does not match row count of B");
+		if(&dst == &a || &dst == &b)
+			throw std::logic_error("destination of a product must not be a factor");
+
+		int r = a.rows();
+		int c = b.columns();
+		int n = a.columns();
+		if(dst.rows() != r || dst.columns() != c)
+			dst = matrix<K>(r, c);
+
+		using traits = accumulator_traits<K>;
+		using accumulator = typename traits::type;
+		if constexpr(std::is_same_v<accumulator, K>)
+		{
+			for(int i=0; i<r; i++)
+			{
+				for(int j=0; j<c; j++)
+					dst(i, j) = K(0);
+				for(int k=0; k<n; k++)
+				{
+					const K& f = a(i, k);
+					if(skip_zero_factors<K> && f == K(0))
+						continue;
+					for(int j=0; j<c; j++)
+						dst(i, j) += f * b(k, j);
+				}
+			}
+		}
+		else
+		{
+			// accumulate a whole row before converting back to K
+			std::vector<accumulator> sums(c);
+			for(int i=0; i<r; i++)
+			{
+				std::fill(sums.begin(), sums.end(), accumulator());
+				for(int k=0; k<n; k++)
+				{
+					const K& f = a(i, k);
+					if(skip_zero_factors<K> && f == K(0))
+						continue;
+					for(int j=0; j<c; j++)
+						traits::add_product(sums[j], f, b(k, j));
+				}
+				for(int j=0; j<c; j++)
+					dst(i, j) = traits::value(sums[j]);
+			}
+		}
+	}
+
+	/**
+	 * Lazy product of several matrices.
+	 * The factors are only multiplied when the product is evaluated. At that point
+	 * the cheapest parenthesization is chosen with the classic matrix-chain dynamic
+	 * programming on the known dimensions.
+	 * Factors that are lvalue matrices are referenced and must outlive the chain,
+	 * temporaries are moved into the chain.
+	 */
+	template<typename K>
+	class product_chain
+	{
+		public:
+			using value_type = K;
+
+			int rows() const { return m_factors.front()->rows(); }
+			int columns() const { return m_factors.back()->columns(); }
+
+			const K& operator()(int row, int column) const
+			{
+				if(!m_cache)
+					m_cache = std::make_shared<const matrix<K>>(evaluate());
+				return (*m_cache)(row, column);
+			}
+
+			void append(const matrix<K>& m)
+			{
+				append(std::shared_ptr<const matrix<K>>(std::shared_ptr<void>(), &m));
+			}
+			void append(matrix<K>&& m)
+			{
+				append(std::make_shared<const matrix<K>>(std::move(m)));
+			}
+			void append(const product_chain<K>& chain)
+			{
+				for(auto& f : chain.m_factors)
+					append(f);
+			}
+			template<matrix_expression E> requires (!std::is_same_v<E, matrix<K>>)
+			void append(const E& e)
+			{
+				append(std::make_shared<const matrix<K>>(e));
+			}
+
+			/**
+			 * Returns the number of scalar multiplications the chosen order needs.
+			 */
+			long cost() const
+			{
+				auto [costs, splits] = order();
+				return costs[0][m_factors.size()-1];
+			}
+
+			matrix<K> evaluate() const
+			{
+				if(m_cache)
+					return *m_cache;
+				if(m_factors.size() == 1)
+					return *m_factors.front();
+
+				auto [costs, splits] = order();
+				return product(0, m_factors.size()-1, splits);
+			}
+		private:
+			std::vector<std::shared_ptr<const matrix<K>>> m_factors;
+			mutable std::shared_ptr<const matrix<K>> m_cache;
+
+			void append(std::shared_ptr<const matrix<K>> factor)
+			{
+				if(!m_factors.empty() && columns() != factor->rows())
+					throw std::logic_error("colum count of A does not match row count of B");
+				m_factors.push_back(std::move(factor));
+				m_cache.reset();
+			}
+
+			std::tuple<std::vector<std::vector<long>>, std::vector<std::vector<int>>> order() const
+			{
+				int n = m_factors.size();
+				std::vector<long> dims(n+1);
+				dims[0] = m_factors[0]->rows();
+				for(int i=0; i<n; i++)
+					dims[i+1] = m_factors[i]->columns();
+
+				std::vector<std::vector<long>> costs(n, std::vector<long>(n));
+				std::vector<std::vector<int>> splits(n, std::vector<int>(n));
+				for(int length=1; length<n; length++)
+				{
+					for(int i=0; i+length<n; i++)
+					{
+						int j = i+length;
+						costs[i][j] = std::numeric_limits<long>::max();
+						for(int k=i; k<j; k++)
+						{
+							long c = costs[i][k] + costs[k+1][j] + dims[i]*dims[k+1]*dims[j+1];
+							if(c < costs[i][j])
+							{
+								costs[i][j] = c;
+								splits[i][j] = k;
+							}
+						}
+					}
+				}
+				return {costs, splits};
+			}
+
+			matrix<K> product(int i, int j, const std::vector<std::vector<int>>& splits) const
+			{
+				int k = splits[i][j];
+				std::optional<matrix<K>> left, right;
+				if(k > i) left = product(i, k, splits);
+				if(j > k+1) right = product(k+1, j, splits);
+
+				const matrix<K>& a = left ? *left : *m_factors[i];
+				const matrix<K>& b = right ? *right : *m_factors[j];
+				matrix<K> result(a.rows(), b.columns());
+				multiply_into(result, a, b);
+				return result;
+			}
+	};
+
+	template<typename A, typename B>
+		requires lazy_operand<std::remove_cvref_t<A>> && lazy_operand<std::remove_cvref_t<B>>
+	auto operator*(A&& a, B&& b)
+	{
+		using K = std::common_type_t<typename std::remove_cvref_t<A>::value_type, typename std::remove_cvref_t<B>::value_type>;
+		product_chain<K> chain;
+		chain.append(std::forward<A>(a));
+		chain.append(std::forward<B>(b));
+		return chain;
+	}
+
+	template<lazy_operand E> requires (!is_matrix<E>::value)
+	std::ostream& operator<<(std::ostream& out, const E& e)
+	{
+		return out << matrix<typename E::value_type>(e);
+	}
 }
\ No newline at end of file
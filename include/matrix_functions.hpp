@@ -0,0 +1,241 @@
+#pragma once
+
+#include "fixed_matrix.hpp"
+#include "lu.hpp"
+#include "matrix.hpp"
+
+#include <cmath>
+#include <complex>
+#include <concepts>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace unimath
+{
+	template<typename K>
+	concept floating_scalar = std::floating_point<K> ||
+		(requires { typename K::value_type; } && std::floating_point<typename K::value_type> && std::same_as<K, std::complex<typename K::value_type>>);
+
+	/**
+	 * Computes a^k by binary exponentiation, i.e. with at most 2*log2(k) products.
+	 * The products are written into three buffers that are reused,
+	 * so there is no allocation per product.
+	 */
+	template<typename K>
+	matrix<K> pow(const matrix<K>& a, unsigned long k)
+	{
+		if(a.rows() != a.columns())
+			throw std::logic_error("matrix is not quadratic");
+		if(k == 0)
+			return matrix<K>::identity(a.rows());
+
+		matrix<K> base = a;
+		matrix<K> scratch = a;
+		for(; !(k & 1); k >>= 1)
+		{
+			multiply_into(scratch, base, base);
+			std::swap(base, scratch);
+		}
+
+		matrix<K> result = base;
+		for(k >>= 1; k; k >>= 1)
+		{
+			multiply_into(scratch, base, base);
+			std::swap(base, scratch);
+			if(k & 1)
+			{
+				multiply_into(scratch, result, base);
+				std::swap(result, scratch);
+			}
+		}
+		return result;
+	}
+
+	template<typename K, int N>
+	constexpr fixed_matrix<K, N, N> pow(fixed_matrix<K, N, N> a, unsigned long k)
+	{
+		fixed_matrix<K, N, N> result = fixed_matrix<K, N, N>::identity();
+		while(k)
+		{
+			if(k & 1)
+				result = result * a;
+			k >>= 1;
+			if(k)
+				a = a * a;
+		}
+		return result;
+	}
+
+	/**
+	 * Computes the n-th term of the linear recurrence
+	 * x[n] = coefficients[0]*x[n-1] + ... + coefficients[d-1]*x[n-d]
+	 * with x[0], ..., x[d-1] given by initial, using a power of the companion matrix.
+	 */
+	template<typename K>
+	K linear_recurrence(const std::vector<K>& coefficients, const std::vector<K>& initial, unsigned long n)
+	{
+		int d = coefficients.size();
+		if(initial.size() != d)
+			throw std::logic_error("recurrence needs as many initial values as coefficients");
+		if(n < d)
+			return initial[n];
+
+		std::vector<std::vector<K>> companion(d, std::vector<K>(d));
+		companion[0] = coefficients;
+		for(int i=1; i<d; i++)
+			companion[i][i-1] = K(1);
+
+		// maps (x[k+d-1], ..., x[k]) to (x[k+d], ..., x[k+1])
+		matrix<K> p = pow(matrix<K>(companion), n-d+1);
+		K result = K(0);
+		for(int j=0; j<d; j++)
+			result += p(0, j) * initial[d-1-j];
+		return result;
+	}
+
+	/**
+	 * Returns identity*I + sum of c*m over terms, with the shape of like.
+	 */
+	template<typename M, typename K = typename M::value_type>
+	M expm_combine(const M& like, K identity, const std::vector<std::pair<double, const M*>>& terms)
+	{
+		M result = like;
+		for(int i=0; i<like.rows(); i++)
+		{
+			for(int j=0; j<like.columns(); j++)
+			{
+				K v = i == j ? identity : K(0);
+				for(auto& [c, m] : terms)
+					v += K(c) * (*m)(i, j);
+				result(i, j) = v;
+			}
+		}
+		return result;
+	}
+
+	template<typename K>
+	matrix<K> expm_solve(const matrix<K>& q, const matrix<K>& p)
+	{
+		return lu_decomposition<K>(q).solve(p);
+	}
+
+	template<typename K, int N>
+	fixed_matrix<K, N, N> expm_solve(const fixed_matrix<K, N, N>& q, const fixed_matrix<K, N, N>& p)
+	{
+		return q.inverse() * p;
+	}
+
+	template<typename K>
+	void expm_square(matrix<K>& r, int times)
+	{
+		matrix<K> scratch = r;
+		for(int i=0; i<times; i++)
+		{
+			multiply_into(scratch, r, r);
+			std::swap(r, scratch);
+		}
+	}
+
+	template<typename K, int N>
+	void expm_square(fixed_matrix<K, N, N>& r, int times)
+	{
+		for(int i=0; i<times; i++)
+			r = r * r;
+	}
+
+	/**
+	 * Scaling and squaring with the diagonal Pade approximant of degree 3, 5, 7, 9 or 13,
+	 * chosen by the 1-norm as in Higham, "The scaling and squaring method for the
+	 * matrix exponential revisited" (2005).
+	 */
+	template<typename M>
+	M expm_pade(const M& a)
+	{
+		using K = typename M::value_type;
+		if(a.rows() != a.columns())
+			throw std::logic_error("matrix is not quadratic");
+
+		double norm = 0;
+		for(int j=0; j<a.columns(); j++)
+		{
+			double sum = 0;
+			for(int i=0; i<a.rows(); i++)
+				sum += std::abs(a(i, j));
+			norm = std::max(norm, sum);
+		}
+
+		const int degrees[] = {3, 5, 7, 9, 13};
+		const double thetas[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1, 2.097847961257068, 5.371920351148152};
+		int m = 13;
+		for(int i=0; i<5; i++)
+		{
+			if(norm <= thetas[i])
+			{
+				m = degrees[i];
+				break;
+			}
+		}
+
+		int s = 0;
+		if(norm > thetas[4])
+			s = (int)std::ceil(std::log2(norm/thetas[4]));
+		M x = s ? expm_combine(a, K(0), {{std::ldexp(1.0, -s), &a}}) : a;
+
+		std::vector<double> b(m+1);
+		b[0] = 1;
+		for(int j=0; j<m; j++)
+			b[j+1] = b[j] * (m-j) / ((j+1.0) * (2*m-j));
+
+		// even powers x^2, x^4, ...
+		std::vector<M> even;
+		even.push_back(M(x * x));
+		while(2*even.size() < (m == 13 ? 6 : m-1))
+			even.push_back(M(even.back() * even.front()));
+
+		std::vector<std::pair<double, const M*>> odd_terms, even_terms;
+		if(m == 13)
+		{
+			// x^6 is factored out of the highest terms, so only three powers are needed
+			M high_odd = expm_combine(x, K(0), {{b[13], &even[2]}, {b[11], &even[1]}, {b[9], &even[0]}});
+			M high_even = expm_combine(x, K(0), {{b[12], &even[2]}, {b[10], &even[1]}, {b[8], &even[0]}});
+			even.push_back(M(even[2] * high_odd));
+			even.push_back(M(even[2] * high_even));
+			odd_terms = {{1, &even[3]}, {b[7], &even[2]}, {b[5], &even[1]}, {b[3], &even[0]}};
+			even_terms = {{1, &even[4]}, {b[6], &even[2]}, {b[4], &even[1]}, {b[2], &even[0]}};
+		}
+		else
+		{
+			for(int j=2; j<=m; j+=2)
+			{
+				odd_terms.push_back({b[j+1], &even[j/2-1]});
+				even_terms.push_back({b[j], &even[j/2-1]});
+			}
+		}
+
+		M u = M(x * expm_combine(x, K(b[1]), odd_terms));
+		M v = expm_combine(x, K(b[0]), even_terms);
+
+		M p = expm_combine(x, K(0), {{1, &v}, {1, &u}});
+		M q = expm_combine(x, K(0), {{1, &v}, {-1, &u}});
+		M r = expm_solve(q, p);
+		expm_square(r, s);
+		return r;
+	}
+
+	/**
+	 * Computes the matrix exponential e^a, e.g. the transition matrix e^(A*t)
+	 * of the continuous system x' = A*x.
+	 */
+	template<floating_scalar K>
+	matrix<K> expm(const matrix<K>& a)
+	{
+		return expm_pade(a);
+	}
+
+	template<floating_scalar K, int N>
+	fixed_matrix<K, N, N> expm(const fixed_matrix<K, N, N>& a)
+	{
+		return expm_pade(a);
+	}
+}
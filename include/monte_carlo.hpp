@@ -0,0 +1,89 @@
+#pragma once
+
+#include "nodal_analysis.hpp"
+#include "statistics.hpp"
+#include "types.hpp"
+
+#include <vector>
+
+namespace unimath
+{
+	enum class tolerance_distribution
+	{
+		/** uniform in [1 - tolerance, 1 + tolerance] */
+		uniform,
+		/**
+		 * normal with mean 1 and standard deviation tolerance/3, i.e. tolerance is the 3 sigma bound;
+		 * factors <= 0 are drawn again, so large tolerances give a normal distribution cut off at 0
+		 */
+		gaussian
+	};
+
+	/**
+	 * Statistics of one node voltage over all samples of a Monte Carlo run.
+	 */
+	struct tolerance_statistics
+	{
+		/** V(node) with the nominal element values */
+		C nominal;
+		/** of |V(node)| */
+		running_statistics magnitude;
+		/** of arg V(node) in radians */
+		running_statistics phase;
+		/** of |V(node)|/|nominal| - 1, or of |V(node)| if the nominal voltage is 0 */
+		histogram deviation;
+	};
+
+	/**
+	 * Monte Carlo tolerance analysis: solves a circuit many times with element
+	 * values drawn from their tolerances and collects statistics of node
+	 * voltages online, without keeping the samples.
+	 * The samples are solved in batches on thread_pool::shared(). The elements
+	 * without tolerance are stamped once; per sample only the stamps of the
+	 * varied elements are added to them at positions looked up beforehand.
+	 * Every thread keeps its own copy of the circuit and of the LU
+	 * decomposition of the nominal circuit and only refactors it numerically
+	 * per sample, since the matrix pattern does not depend on the values, not
+	 * even on entries that vanish at the frequency. Batch b draws from its own
+	 * random stream seeded with (seed, b). The batches are run in rounds of a
+	 * few per thread and merged in order after every round, so the memory does
+	 * not grow with the number of samples and the result only depends on the
+	 * seed and not on the number of threads.
+	 */
+	class monte_carlo
+	{
+		public:
+			explicit monte_carlo(const circuit& c);
+
+			/**
+			 * Varies the value of an element by the relative tolerance, e.g. 0.05 for 5%.
+			 * Elements without a tolerance keep their nominal value.
+			 * Throws std::domain_error for a negative tolerance and for a uniform
+			 * one of 1 or more, which could change the sign of the value.
+			 */
+			void tolerance(int element, double relative, tolerance_distribution distribution = tolerance_distribution::uniform);
+
+			/**
+			 * Runs samples solves at frequency (in Hz) and returns the statistics
+			 * of the given nodes, in that order. The histograms have bins bins
+			 * between -range and range.
+			 */
+			std::vector<tolerance_statistics> run(double frequency, const std::vector<int>& nodes, long samples,
+				double range = 0.25, int bins = 50, unsigned long seed = 1) const;
+
+			/**
+			 * Samples per batch, i.e. per random stream.
+			 */
+			static constexpr int batch = 256;
+		private:
+			struct variation
+			{
+				int element;
+				double relative;
+				tolerance_distribution distribution;
+			};
+
+			circuit m_circuit;
+			std::vector<variation> m_variations;
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "big_integer.hpp"
+#include "matrix.hpp"
+#include "types.hpp"
+
+namespace unimath
+{
+	/**
+	 * Computes the determinant of an integer matrix exactly.
+	 * The matrix is eliminated modulo several primes below 2^62 in parallel on
+	 * thread_pool::shared(), and the results are combined with the Chinese
+	 * remainder theorem.
+	 * As many primes are used as the Hadamard bound of the determinant requires,
+	 * so the size of the determinant is not limited.
+	 * Throws std::logic_error if the matrix is not quadratic.
+	 */
+	big_integer multimodular_det(const matrix<Z>& m);
+
+	/**
+	 * Computes the rank of an integer matrix over the rationals by elimination
+	 * modulo several primes in parallel.
+	 * The rank modulo a prime can only be smaller, namely if the prime divides all
+	 * nonzero minors of maximal size, so enough primes are used for their product
+	 * to exceed the Hadamard bound of these minors, without a limit on its size.
+	 */
+	int multimodular_rank(const matrix<Z>& m);
+
+	/**
+	 * Computes the dimension of the nullspace of an integer matrix, i.e. columns - rank.
+	 */
+	int multimodular_nullity(const matrix<Z>& m);
+}
@@ -1,2 +1,218 @@
 #pragma once
 
+#include "polynom.hpp"
+#include "sparse_matrix.hpp"
+#include "types.hpp"
+
+#include <functional>
+#include <tuple>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Node voltages and element currents of a solved circuit.
+	 */
+	class ac_solution
+	{
+		public:
+			ac_solution(std::vector<C> voltages, std::vector<C> currents) : m_voltages(std::move(voltages)), m_currents(std::move(currents))
+			{
+			}
+
+			/**
+			 * Voltage of a node against ground (node 0).
+			 */
+			C voltage(int node) const { return m_voltages[node]; }
+			C voltage(int a, int b) const { return m_voltages[a] - m_voltages[b]; }
+			/**
+			 * Current through an element, flowing from its first to its second node.
+			 */
+			C current(int element) const { return m_currents[element]; }
+
+			const std::vector<C>& voltages() const { return m_voltages; }
+			const std::vector<C>& currents() const { return m_currents; }
+		private:
+			std::vector<C> m_voltages;
+			std::vector<C> m_currents;
+	};
+
+	/**
+	 * Linear circuit for modified nodal analysis (MNA).
+	 * Nodes are non-negative integers, node 0 is ground. The add functions
+	 * return the index of the new element, which identifies it in an
+	 * ac_solution and as the controlling branch of current controlled sources.
+	 * Source values are phasors. Currents flow from the first node of an
+	 * element through the element to its second node.
+	 *
+	 * The unknowns are the voltages of the nodes 1..n followed by one branch
+	 * current for every voltage source, voltage controlled voltage source,
+	 * current controlled voltage source and inductor. The latter keeps
+	 * inductors well defined at DC, where they are shorts.
+	 */
+	class circuit
+	{
+		public:
+			enum class element_type
+			{
+				resistor,
+				capacitor,
+				inductor,
+				voltage_source,
+				current_source,
+				/** E: V(a, b) = gain*V(c, d) */
+				vcvs,
+				/** G: I(a -> b) = gain*V(c, d) */
+				vccs,
+				/** F: I(a -> b) = gain*I(control) */
+				cccs,
+				/** H: V(a, b) = gain*I(control) */
+				ccvs
+			};
+
+			struct element
+			{
+				element_type type;
+				int a, b;
+				int c = 0, d = 0;
+				/**
+				 * Resistance, capacitance, inductance, source phasor or gain.
+				 */
+				C value;
+				/**
+				 * Controlling element of cccs and ccvs.
+				 */
+				int control = -1;
+				/**
+				 * Index of the branch current among the unknowns, or -1.
+				 */
+				int branch = -1;
+			};
+
+			int resistor(int a, int b, double resistance);
+			int capacitor(int a, int b, double capacitance);
+			int inductor(int a, int b, double inductance);
+			int voltage_source(int a, int b, C voltage);
+			int current_source(int a, int b, C current);
+			int vcvs(int a, int b, int c, int d, double gain);
+			int vccs(int a, int b, int c, int d, double transconductance);
+			/**
+			 * control must be an element with a branch current, i.e. a voltage
+			 * source, vcvs, ccvs or inductor.
+			 */
+			int cccs(int a, int b, int control, double gain);
+			int ccvs(int a, int b, int control, double transresistance);
+			/**
+			 * Reserves space for the given number of elements.
+			 */
+			void reserve(int elements) { m_elements.reserve(elements); }
+
+			/**
+			 * Number of nodes including ground.
+			 */
+			int nodes() const { return m_nodes; }
+			/**
+			 * Number of unknowns of the MNA system.
+			 */
+			int unknowns() const { return m_nodes - 1 + m_branches; }
+			const std::vector<element>& elements() const { return m_elements; }
+			/**
+			 * Changes the value of an element (see element::value), e.g. to
+			 * evaluate the same circuit with other component values.
+			 */
+			void value(int element, C value);
+
+			/**
+			 * The MNA matrix for the complex frequency s = j*omega.
+			 */
+			sparse_matrix<C> system_matrix(C s) const;
+			/**
+			 * Splits the MNA matrix into A(s) = G + s*M. Returns a pattern that holds
+			 * every entry of A(s) for any s; the k-th value of A(s) is g[k] + s*m[k].
+			 */
+			sparse_matrix<C> system_pattern(std::vector<C>& g, std::vector<C>& m) const;
+			/**
+			 * Appends the stamp of one element at s to entries, i.e. its part of
+			 * system_matrix(s). The number and positions of the entries only
+			 * depend on the type and nodes of the element, not on its value.
+			 */
+			void stamp(int element, C s, std::vector<sparse_matrix<C>::triplet>& entries) const;
+			/**
+			 * The right hand side of the MNA system with the source phasors.
+			 */
+			std::vector<C> excitation() const;
+			/**
+			 * Adds weight times the part of one element in excitation() to b.
+			 */
+			void excitation(int element, std::vector<C>& b, double weight = 1) const;
+
+			/**
+			 * Solves the circuit at the given frequency in Hz (0 for DC).
+			 * Throws std::logic_error if the system is singular, e.g. because
+			 * of a floating node or a loop of voltage sources.
+			 */
+			ac_solution solve(double frequency) const;
+			/**
+			 * Turns the unknowns of the MNA system at s into voltages and currents.
+			 */
+			ac_solution solution(C s, const std::vector<C>& x) const;
+			/**
+			 * The voltage of node as a rational function N(s)/D(s) of the complex
+			 * frequency, for the sources as given; with a single source of value 1
+			 * this is the transfer function from that source. Returns {N, D}, e.g.
+			 * for complex_pfd(N, D), with D monic.
+			 * D is the determinant of the MNA matrix, so its degree is at most the
+			 * number of capacitors and inductors, and N = D*V(node) by Cramer's rule.
+			 * Both are evaluated at 2^k points on a circle around the origin and
+			 * their coefficients are interpolated by an FFT. The radius is adjusted
+			 * to the geometric mean of the poles, where the coefficients are
+			 * balanced; those smaller than tolerance times the largest there are
+			 * dropped. Common roots of N and D, e.g. modes that are not observable
+			 * at node, are not cancelled.
+			 */
+			std::tuple<polynom, polynom> transfer_function(int node, double tolerance = 1e-9) const;
+		private:
+			int m_nodes = 1;
+			int m_branches = 0;
+			std::vector<element> m_elements;
+
+			int add(element e, bool branch);
+			void stamp(C s, std::vector<sparse_matrix<C>::triplet>& entries) const;
+	};
+
+	/**
+	 * Solves one circuit at many frequencies.
+	 * The MNA pattern and its fill-reducing column order are computed once,
+	 * and the pivot sequence once per run. Each frequency then only fills in
+	 * the values of G + s*M and refactors them numerically with the same
+	 * pattern; only if a pivot becomes too small there, that frequency gets
+	 * a full factorization with pivoting. The frequencies are distributed
+	 * over thread_pool::shared(), and results are handed out per point
+	 * instead of being collected.
+	 */
+	class ac_sweep
+	{
+		public:
+			explicit ac_sweep(const circuit& c);
+
+			/**
+			 * Calls callback(i, solution) for every frequencies[i] (in Hz).
+			 * Calls for different i may run concurrently on different threads
+			 * and in any order.
+			 */
+			void run(const std::vector<double>& frequencies, const std::function<void(int, const ac_solution&)>& callback) const;
+			/**
+			 * Writes the voltage of nodes[k] at frequencies[i] to out[k*frequencies.size() + i],
+			 * i.e. one column per node. out must have room for nodes.size()*frequencies.size() values.
+			 */
+			void run(const std::vector<double>& frequencies, const std::vector<int>& nodes, C* out) const;
+		private:
+			circuit m_circuit;
+			sparse_matrix<C> m_pattern;
+			std::vector<C> m_g, m_m;
+			std::vector<C> m_b;
+			std::vector<int> m_order;
+
+			void sweep(const std::vector<double>& frequencies, const std::function<void(int, C, const std::vector<C>&)>& consume) const;
+	};
+}
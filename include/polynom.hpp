@@ -9,6 +9,8 @@
 
 namespace unimath
 {
+	class render_buffer;
+
 	class polynom
 	{
 		public:
@@ -93,9 +95,10 @@ namespace unimath
 		private:
 			std::vector<C> m_coefficients;
 
-			friend std::ostream& operator<<(std::ostream&, const polynom&);
+			friend void render(render_buffer&, const polynom&);
 			friend polynom divHelper(const polynom p, const polynom q, std::vector<C>& coeffs);
 	};
+	void render(render_buffer&, const polynom&);
 	std::ostream& operator<<(std::ostream&, const unimath::polynom&);
 
 	struct partial_fraction
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "types.hpp"
+
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Householder QR decomposition A = Q*R that consumes the rows of A in blocks.
+	 * Only the n x n triangular factor R and Q^H*b are kept, so tall systems
+	 * (millions of rows, few columns) can be solved in the least squares sense
+	 * without ever holding A in memory.
+	 * Each block is stacked below the current R, and the Householder reflectors
+	 * only touch the diagonal of R and the rows of the block.
+	 */
+	template<typename K>
+	class streaming_qr
+	{
+		public:
+			streaming_qr(int columns) : m_columns(columns), m_r(columns*columns), m_qtb(columns), m_residual(0)
+			{
+			}
+
+			int columns() const { return m_columns; }
+			long rows() const { return m_rows; }
+
+			/**
+			 * Adds the rows of block together with the matching entries of the right hand side b.
+			 */
+			void add_rows(const matrix<K>& block, const std::vector<K>& b)
+			{
+				if(block.columns() != m_columns)
+					throw std::logic_error("column count does not match");
+				if(block.rows() != b.size())
+					throw std::logic_error("right hand side does not match row count");
+
+				int m = block.rows();
+				int n = m_columns;
+				m_work.resize(m*n);
+				for(int i=0; i<m; i++)
+					for(int j=0; j<n; j++)
+						m_work[i*n+j] = block(i, j);
+				m_rhs = b;
+
+				for(int k=0; k<n; k++)
+				{
+					K& rkk = m_r[k*n+k];
+
+					double norm = std::norm(rkk);
+					for(int i=0; i<m; i++)
+						norm += std::norm(m_work[i*n+k]);
+					norm = std::sqrt(norm);
+					if(norm == 0)
+						continue;
+
+					double a = std::abs(rkk);
+					K alpha = -(a == 0 ? K(1) : rkk/a) * K(norm);
+					K v0 = rkk - alpha;
+					double vnorm = std::norm(v0);
+					for(int i=0; i<m; i++)
+						vnorm += std::norm(m_work[i*n+k]);
+					K beta = K(2.0/vnorm);
+
+					for(int j=k+1; j<n; j++)
+					{
+						K s = conjugate(v0) * m_r[k*n+j];
+						for(int i=0; i<m; i++)
+							s += conjugate(m_work[i*n+k]) * m_work[i*n+j];
+						s *= beta;
+						m_r[k*n+j] -= v0 * s;
+						for(int i=0; i<m; i++)
+							m_work[i*n+j] -= m_work[i*n+k] * s;
+					}
+
+					K s = conjugate(v0) * m_qtb[k];
+					for(int i=0; i<m; i++)
+						s += conjugate(m_work[i*n+k]) * m_rhs[i];
+					s *= beta;
+					m_qtb[k] -= v0 * s;
+					for(int i=0; i<m; i++)
+						m_rhs[i] -= m_work[i*n+k] * s;
+
+					rkk = alpha;
+				}
+
+				// whatever is left of the right hand side cannot be reached by any x
+				for(int i=0; i<m; i++)
+					m_residual += std::norm(m_rhs[i]);
+				m_rows += m;
+			}
+
+			/**
+			 * Returns the triangular factor R.
+			 */
+			matrix<K> r() const
+			{
+				std::vector<std::vector<K>> entries(m_columns, std::vector<K>(m_columns));
+				for(int i=0; i<m_columns; i++)
+					for(int j=i; j<m_columns; j++)
+						entries[i][j] = m_r[i*m_columns+j];
+				return matrix<K>(entries);
+			}
+
+			/**
+			 * Returns the x minimizing ||A*x - b|| for all rows added so far.
+			 * Throws std::logic_error if A does not have full column rank.
+			 */
+			std::vector<K> solve() const
+			{
+				int n = m_columns;
+
+				double largest = 0;
+				for(int k=0; k<n; k++)
+					largest = std::max(largest, (double)std::abs(m_r[k*n+k]));
+
+				std::vector<K> x = m_qtb;
+				for(int k=n-1; k>=0; k--)
+				{
+					if(std::abs(m_r[k*n+k]) <= largest * n * 1e-15)
+						throw std::logic_error("matrix does not have full column rank");
+					for(int j=k+1; j<n; j++)
+						x[k] -= m_r[k*n+j] * x[j];
+					x[k] /= m_r[k*n+k];
+				}
+				return x;
+			}
+
+			/**
+			 * Returns ||A*x - b|| for the least squares solution x.
+			 */
+			double residual_norm() const
+			{
+				return std::sqrt(m_residual);
+			}
+		private:
+			int m_columns;
+			long m_rows = 0;
+			std::vector<K> m_r;
+			std::vector<K> m_qtb;
+			double m_residual;
+
+			std::vector<K> m_work;
+			std::vector<K> m_rhs;
+	};
+
+	/**
+	 * Solves the overdetermined system A*x = b in the least squares sense,
+	 * feeding A to a streaming_qr in blocks of block_rows rows.
+	 */
+	template<typename K>
+	std::vector<K> least_squares(const matrix<K>& a, const std::vector<K>& b, int block_rows = 256)
+	{
+		if(a.rows() != b.size())
+			throw std::logic_error("right hand side does not match row count");
+
+		streaming_qr<K> qr(a.columns());
+		for(int first=0; first<a.rows(); first+=block_rows)
+		{
+			int count = std::min(block_rows, a.rows()-first);
+			std::vector<std::vector<K>> entries(count, std::vector<K>(a.columns()));
+			for(int i=0; i<count; i++)
+				for(int j=0; j<a.columns(); j++)
+					entries[i][j] = a(first+i, j);
+			qr.add_rows(matrix<K>(entries), std::vector<K>(b.begin()+first, b.begin()+first+count));
+		}
+		return qr.solve();
+	}
+}
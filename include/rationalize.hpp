@@ -0,0 +1,20 @@
+#pragma once
+
+#include "fraction.hpp"
+#include "matrix.hpp"
+
+namespace unimath
+{
+	/**
+	 * Converts every entry with fraction(double), i.e. to the first convergent
+	 * that converts back to the same double. Rows are converted in parallel.
+	 * Throws like fraction(double) for entries that cannot be represented.
+	 */
+	matrix<fraction> rationalize(const matrix<double>& m);
+
+	/**
+	 * Converts every entry to the closest fraction with a denominator of at
+	 * most max_denominator. Rows are converted in parallel.
+	 */
+	matrix<fraction> rationalize(const matrix<double>& m, long max_denominator);
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <charconv>
+#include <complex>
+#include <concepts>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace unimath
+{
+	/**
+	 * Character buffer that formats numbers with std::to_chars instead of iostreams.
+	 * The floating point format, the precision and the latex flag are taken from
+	 * the stream the text is meant for, so the result matches what operator<<
+	 * would write. Clearing keeps the allocated memory, so one buffer can be
+	 * reused for any number of values.
+	 */
+	class render_buffer
+	{
+		public:
+			/**
+			 * Clears the buffer and takes over the format of out.
+			 */
+			void reset(std::ostream& out);
+			void clear() { m_text.clear(); }
+
+			bool latex() const { return m_latex; }
+			std::ostream& stream() const { return *m_stream; }
+
+			int size() const { return m_text.size(); }
+			const char* data() const { return m_text.data(); }
+			std::string_view view(int begin, int end) const { return std::string_view(m_text).substr(begin, end-begin); }
+
+			void append(char c) { m_text.push_back(c); }
+			void append(std::string_view text) { m_text.append(text); }
+			void append(const char* text) { m_text.append(text); }
+			void append(const render_buffer& other, int begin, int end) { m_text.append(other.m_text, begin, end-begin); }
+			void pad(int count, char c = ' ') { if(count > 0) m_text.append(count, c); }
+
+			template<std::integral T>
+			void append_integer(T value)
+			{
+				char digits[64];
+				auto [end, error] = std::to_chars(digits, digits+sizeof(digits), value);
+				m_text.append(digits, end);
+			}
+
+			template<std::floating_point T>
+			void append_floating(T value)
+			{
+				if(!m_stream_only)
+				{
+					char digits[512];
+					std::to_chars_result result;
+					if(m_format == std::chars_format::hex)
+						result = std::to_chars(digits, digits+sizeof(digits), value, m_format);
+					else
+						result = std::to_chars(digits, digits+sizeof(digits), value, m_format, m_precision);
+					if(result.ec == std::errc())
+					{
+						m_text.append(digits, result.ptr);
+						return;
+					}
+				}
+
+				// huge numbers in fixed notation
+				std::ostringstream oss;
+				oss.copyfmt(*m_stream);
+				oss.width(0);
+				oss << value;
+				m_text.append(oss.view());
+			}
+
+			/**
+			 * Writes the text to out as one field: padded with out.fill() to
+			 * out.width() as out.flags() & adjustfield says, after which the
+			 * width is reset like formatted output does.
+			 */
+			void write(std::ostream& out) const;
+		private:
+			std::string m_text;
+			std::ostream* m_stream = nullptr;
+			std::chars_format m_format = std::chars_format::general;
+			int m_precision = 6;
+			bool m_latex = false;
+			/**
+			 * Flags like showpos that to_chars cannot reproduce.
+			 */
+			bool m_stream_only = false;
+	};
+
+	/**
+	 * Borrows a cleared render_buffer from a per-thread pool for as long as it lives.
+	 * Nested renderers get different buffers, and the memory is kept for the
+	 * next output on the same thread.
+	 */
+	class render_lease
+	{
+		public:
+			render_lease(std::ostream& out);
+			~render_lease();
+			render_lease(const render_lease&) = delete;
+			render_lease& operator=(const render_lease&) = delete;
+
+			render_buffer& operator*() const { return *m_buffer; }
+			render_buffer* operator->() const { return m_buffer; }
+		private:
+			render_buffer* m_buffer;
+	};
+
+	/**
+	 * Types without their own renderer go through their operator<<.
+	 */
+	template<typename T>
+	void render(render_buffer& buffer, const T& value)
+	{
+		std::ostringstream oss;
+		oss.copyfmt(buffer.stream());
+		oss.width(0);
+		oss << value;
+		buffer.append(oss.view());
+	}
+
+	template<typename T> requires std::integral<T> && (!std::same_as<T, bool>) && (!std::same_as<T, char>)
+	void render(render_buffer& buffer, const T& value)
+	{
+		buffer.append_integer(value);
+	}
+
+	template<std::floating_point T>
+	void render(render_buffer& buffer, const T& value)
+	{
+		buffer.append_floating(value);
+	}
+
+	template<typename T>
+	void render(render_buffer& buffer, const std::complex<T>& c)
+	{
+		if(!buffer.latex())
+		{
+			buffer.append('(');
+			render(buffer, c.real());
+			buffer.append(',');
+			render(buffer, c.imag());
+			buffer.append(')');
+			return;
+		}
+
+		if(c.imag() == T(0))
+		{
+			render(buffer, c.real());
+		}
+		else if(c.real() == T(0))
+		{
+			if(c.imag() == T(1))
+				buffer.append('i');
+			else if(c.imag() == T(-1))
+				buffer.append("-i");
+			else
+			{
+				render(buffer, c.imag());
+				buffer.append('i');
+			}
+		}
+		else
+		{
+			buffer.append('(');
+			render(buffer, c.real());
+			if(c.imag() == T(1))
+				buffer.append(" + i");
+			else if(c.imag() == T(-1))
+				buffer.append(" - i");
+			else
+			{
+				bool negative = c.imag() < T(0);
+				buffer.append(negative ? " - " : " + ");
+				render(buffer, negative ? -c.imag() : c.imag());
+				buffer.append('i');
+			}
+			buffer.append(')');
+		}
+	}
+
+	/**
+	 * Renders value into a pooled buffer and writes it to out in one piece.
+	 */
+	template<typename T>
+	std::ostream& render_to(std::ostream& out, const T& value)
+	{
+		render_lease buffer(out);
+		render(*buffer, value);
+		buffer->write(out);
+		return out;
+	}
+}
@@ -0,0 +1,603 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * A sparse matrix in compressed sparse row (CSR) format.
+	 * The column indices of every row are sorted and unique.
+	 * The constructors do not store explicit zeros, but values changed
+	 * through values() keep their place in the pattern even if they are zero.
+	 */
+	template<typename K>
+	class sparse_matrix
+	{
+		public:
+			using value_type = K;
+			using triplet = std::tuple<int, int, K>;
+
+			sparse_matrix(int rows = 0, int columns = 0) : m_rows(rows), m_columns(columns), m_row_pointers(rows+1, 0)
+			{
+			}
+
+			/**
+			 * Creates a sparse matrix from a list of (row, column, value) entries.
+			 * The entries may come in any order. Entries for the same position are summed up,
+			 * which is what stamping a circuit into an admittance matrix needs.
+			 */
+			sparse_matrix(int rows, int columns, std::vector<triplet> entries) : m_rows(rows), m_columns(columns), m_row_pointers(rows+1, 0)
+			{
+				std::sort(entries.begin(), entries.end(), [](const triplet& a, const triplet& b){
+					return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) < std::get<0>(b) : std::get<1>(a) < std::get<1>(b);
+				});
+
+				m_column_indices.reserve(entries.size());
+				m_values.reserve(entries.size());
+				for(int e=0; e<entries.size(); )
+				{
+					auto [r, c, v] = entries[e];
+					if(r < 0 || r >= rows || c < 0 || c >= columns)
+						throw std::out_of_range("sparse matrix entry out of range");
+
+					for(e++; e<entries.size() && std::get<0>(entries[e]) == r && std::get<1>(entries[e]) == c; e++)
+						v += std::get<2>(entries[e]);
+
+					if(v == K(0))
+						continue;
+					m_column_indices.push_back(c);
+					m_values.push_back(v);
+					m_row_pointers[r+1]++;
+				}
+				for(int i=0; i<rows; i++)
+					m_row_pointers[i+1] += m_row_pointers[i];
+			}
+
+			explicit sparse_matrix(const matrix<K>& m) : m_rows(m.rows()), m_columns(m.columns()), m_row_pointers(m.rows()+1, 0)
+			{
+				for(int i=0; i<m_rows; i++)
+				{
+					for(int j=0; j<m_columns; j++)
+					{
+						if(m(i, j) == K(0))
+							continue;
+						m_column_indices.push_back(j);
+						m_values.push_back(m(i, j));
+					}
+					m_row_pointers[i+1] = m_values.size();
+				}
+			}
+
+			matrix<K> dense() const
+			{
+				std::vector<std::vector<K>> entries(m_rows, std::vector<K>(m_columns));
+				for(int i=0; i<m_rows; i++)
+					for(int p=m_row_pointers[i]; p<m_row_pointers[i+1]; p++)
+						entries[i][m_column_indices[p]] = m_values[p];
+				return matrix<K>(entries);
+			}
+
+			int rows() const { return m_rows; }
+			int columns() const { return m_columns; }
+			int nonzeros() const { return m_values.size(); }
+
+			const std::vector<int>& row_pointers() const { return m_row_pointers; }
+			const std::vector<int>& column_indices() const { return m_column_indices; }
+			const std::vector<K>& values() const { return m_values; }
+			/**
+			 * The stored values in pattern order, for changing a matrix without changing its pattern.
+			 */
+			std::vector<K>& values() { return m_values; }
+
+			/**
+			 * Returns the index of the entry (row, column) in values(), or -1 if it is not stored.
+			 */
+			int find(int row, int column) const
+			{
+				auto begin = m_column_indices.begin() + m_row_pointers[row];
+				auto end = m_column_indices.begin() + m_row_pointers[row+1];
+				auto it = std::lower_bound(begin, end, column);
+				if(it == end || *it != column)
+					return -1;
+				return it - m_column_indices.begin();
+			}
+
+			K operator()(int row, int column) const
+			{
+				int p = find(row, column);
+				return p < 0 ? K(0) : m_values[p];
+			}
+
+			/**
+			 * Computes y = A*x without allocating.
+			 */
+			void multiply(const std::vector<K>& x, std::vector<K>& y) const
+			{
+				if(x.size() != m_columns)
+					throw std::logic_error("vector size does not match column count");
+				y.resize(m_rows);
+				for(int i=0; i<m_rows; i++)
+				{
+					K sum = K(0);
+					for(int p=m_row_pointers[i]; p<m_row_pointers[i+1]; p++)
+						sum += m_values[p] * x[m_column_indices[p]];
+					y[i] = sum;
+				}
+			}
+
+			std::vector<K> operator*(const std::vector<K>& x) const
+			{
+				std::vector<K> y;
+				multiply(x, y);
+				return y;
+			}
+
+			/**
+			 * Returns the transposed matrix.
+			 * The CSR storage of the transpose is the compressed sparse column (CSC)
+			 * storage of this matrix.
+			 */
+			sparse_matrix<K> transpose() const
+			{
+				sparse_matrix<K> t(m_columns, m_rows);
+				t.m_column_indices.resize(m_values.size());
+				t.m_values.resize(m_values.size());
+
+				for(int c : m_column_indices)
+					t.m_row_pointers[c+1]++;
+				for(int j=0; j<m_columns; j++)
+					t.m_row_pointers[j+1] += t.m_row_pointers[j];
+
+				std::vector<int> next(t.m_row_pointers.begin(), t.m_row_pointers.end()-1);
+				for(int i=0; i<m_rows; i++)
+				{
+					for(int p=m_row_pointers[i]; p<m_row_pointers[i+1]; p++)
+					{
+						int q = next[m_column_indices[p]]++;
+						t.m_column_indices[q] = i;
+						t.m_values[q] = m_values[p];
+					}
+				}
+				return t;
+			}
+		private:
+			int m_rows;
+			int m_columns;
+			std::vector<int> m_row_pointers;
+			std::vector<int> m_column_indices;
+			std::vector<K> m_values;
+	};
+
+	// dense expressions of sparse operands would evaluate every entry by a binary search
+	template<typename K>
+	inline constexpr bool lazy_matrix_operators<sparse_matrix<K>> = false;
+
+	/**
+	 * Computes a fill-reducing elimination order for the pattern of A+A^T
+	 * using the minimum degree heuristic on the elimination graph.
+	 * Rows that are much denser than the rest (e.g. the branch of a voltage source
+	 * connected to many nodes) are moved to the end instead of being eliminated early.
+	 */
+	template<typename K>
+	std::vector<int> minimum_degree(const sparse_matrix<K>& a)
+	{
+		if(a.rows() != a.columns())
+			throw std::logic_error("matrix is not quadratic");
+		int n = a.rows();
+
+		std::vector<std::vector<int>> adjacency(n);
+		auto& rp = a.row_pointers();
+		auto& ci = a.column_indices();
+		for(int i=0; i<n; i++)
+		{
+			for(int p=rp[i]; p<rp[i+1]; p++)
+			{
+				if(ci[p] == i)
+					continue;
+				adjacency[i].push_back(ci[p]);
+				adjacency[ci[p]].push_back(i);
+			}
+		}
+		for(auto& adj : adjacency)
+		{
+			std::sort(adj.begin(), adj.end());
+			adj.erase(std::unique(adj.begin(), adj.end()), adj.end());
+		}
+
+		int dense = std::max(16, (int)(10*std::sqrt((double)n)));
+		std::vector<int> order;
+		order.reserve(n);
+		std::vector<int> postponed;
+
+		std::set<std::pair<int, int>> degrees;
+		std::vector<bool> eliminated(n);
+		for(int i=0; i<n; i++)
+		{
+			if(adjacency[i].size() > dense)
+			{
+				postponed.push_back(i);
+				eliminated[i] = true;
+			}
+			else
+				degrees.insert({adjacency[i].size(), i});
+		}
+		if(!postponed.empty())
+		{
+			for(auto& adj : adjacency)
+				std::erase_if(adj, [&eliminated](int j){return eliminated[j];});
+			degrees.clear();
+			for(int i=0; i<n; i++)
+				if(!eliminated[i])
+					degrees.insert({adjacency[i].size(), i});
+		}
+
+		std::vector<int> merged;
+		while(!degrees.empty())
+		{
+			int v = degrees.begin()->second;
+			degrees.erase(degrees.begin());
+			order.push_back(v);
+			eliminated[v] = true;
+
+			// the neighbours of v become a clique
+			auto& neighbours = adjacency[v];
+			for(int u : neighbours)
+			{
+				auto& adj = adjacency[u];
+				degrees.erase({adj.size(), u});
+
+				merged.clear();
+				std::set_union(adj.begin(), adj.end(), neighbours.begin(), neighbours.end(), std::back_inserter(merged));
+				std::erase_if(merged, [u, v](int j){return j == u || j == v;});
+				adj.swap(merged);
+
+				degrees.insert({adj.size(), u});
+			}
+			std::vector<int>().swap(neighbours);
+		}
+
+		order.insert(order.end(), postponed.begin(), postponed.end());
+		return order;
+	}
+
+	/**
+	 * Sparse LU decomposition P*A*Q = L*U using the left-looking algorithm of
+	 * Gilbert and Peierls, i.e. one sparse triangular solve per column.
+	 * The columns are ordered by minimum_degree() to reduce fill-in.
+	 * Rows are chosen by threshold partial pivoting: the diagonal entry is kept
+	 * as long as its magnitude is at least pivot_tolerance times the largest
+	 * candidate of the column, which preserves the symmetric ordering.
+	 */
+	template<typename K>
+	class sparse_lu
+	{
+		public:
+			sparse_lu(const sparse_matrix<K>& a, double pivot_tolerance = 0.1) : sparse_lu(a, minimum_degree(a), pivot_tolerance)
+			{
+			}
+
+			sparse_lu(const sparse_matrix<K>& a, std::vector<int> column_order, double pivot_tolerance = 0.1) :
+				m_n(a.rows()), m_q(std::move(column_order)), m_pivot_tolerance(pivot_tolerance)
+			{
+				if(a.rows() != a.columns())
+					throw std::logic_error("matrix is not quadratic");
+				if(m_q.size() != m_n)
+					throw std::logic_error("column order does not match matrix size");
+				factor(a.transpose());
+			}
+
+			int size() const { return m_n; }
+			int nonzeros() const { return m_l_values.size() + m_u_values.size(); }
+
+			/**
+			 * Solves A*x = b in place, i.e. x contains b on input.
+			 */
+			void solve_in_place(std::vector<K>& x) const
+			{
+				if(x.size() != m_n)
+					throw std::logic_error("vector size does not match matrix size");
+
+				std::vector<K> y(m_n);
+				for(int i=0; i<m_n; i++)
+					y[m_pinv[i]] = x[i];
+
+				for(int k=0; k<m_n; k++)
+				{
+					K yk = y[k];
+					if(yk == K(0))
+						continue;
+					for(int p=m_l_pointers[k]+1; p<m_l_pointers[k+1]; p++)
+						y[m_l_indices[p]] -= m_l_values[p] * yk;
+				}
+
+				for(int k=m_n-1; k>=0; k--)
+				{
+					int diagonal = m_u_pointers[k+1]-1;
+					y[k] /= m_u_values[diagonal];
+					K yk = y[k];
+					if(yk == K(0))
+						continue;
+					for(int p=m_u_pointers[k]; p<diagonal; p++)
+						y[m_u_indices[p]] -= m_u_values[p] * yk;
+				}
+
+				for(int k=0; k<m_n; k++)
+					x[m_q[k]] = y[k];
+			}
+
+			std::vector<K> solve(const std::vector<K>& b) const
+			{
+				std::vector<K> x = b;
+				solve_in_place(x);
+				return x;
+			}
+
+			/**
+			 * Recomputes the factors for a matrix with the same pattern as the one
+			 * this decomposition was computed for. The column order, the pivot rows
+			 * and the patterns of L and U are kept, so only the numeric part of the
+			 * factorization runs again.
+			 * Returns false if a pivot no longer satisfies the threshold of the
+			 * partial pivoting. The decomposition is unusable then and has to be
+			 * computed anew.
+			 */
+			bool refactor(const sparse_matrix<K>& a)
+			{
+				if(a.rows() != m_n || a.columns() != m_n)
+					throw std::logic_error("matrix size does not match decomposition");
+
+				sparse_matrix<K> at = a.transpose();
+				auto& rp = at.row_pointers();
+				auto& ci = at.column_indices();
+				auto& values = at.values();
+
+				std::vector<K> x(m_n);
+				for(int k=0; k<m_n; k++)
+				{
+					// scatter A(:,col) in permuted row numbering
+					for(int p=m_u_pointers[k]; p<m_u_pointers[k+1]; p++)
+						x[m_u_indices[p]] = K(0);
+					for(int p=m_l_pointers[k]; p<m_l_pointers[k+1]; p++)
+						x[m_l_indices[p]] = K(0);
+					int col = m_q[k];
+					for(int p=rp[col]; p<rp[col+1]; p++)
+						x[m_pinv[ci[p]]] = values[p];
+
+					// the entries of U are stored in topological order
+					int diagonal = m_u_pointers[k+1]-1;
+					for(int p=m_u_pointers[k]; p<diagonal; p++)
+					{
+						int j = m_u_indices[p];
+						K xj = x[j];
+						m_u_values[p] = xj;
+						for(int q=m_l_pointers[j]+1; q<m_l_pointers[j+1]; q++)
+							x[m_l_indices[q]] -= m_l_values[q] * xj;
+					}
+
+					K pivot = x[k];
+					double largest = std::abs(pivot);
+					for(int q=m_l_pointers[k]+1; q<m_l_pointers[k+1]; q++)
+						largest = std::max(largest, (double)std::abs(x[m_l_indices[q]]));
+					if(largest <= 0 || std::abs(pivot) < m_pivot_tolerance*largest)
+						return false;
+
+					m_u_values[diagonal] = pivot;
+					for(int q=m_l_pointers[k]+1; q<m_l_pointers[k+1]; q++)
+						m_l_values[q] = x[m_l_indices[q]] / pivot;
+				}
+				return true;
+			}
+
+			K determinant() const
+			{
+				K det = K(1);
+				for(int k=0; k<m_n; k++)
+					det *= m_u_values[m_u_pointers[k+1]-1];
+				if(permutation_parity(m_pinv) != permutation_parity(m_q))
+					det = -det;
+				return det;
+			}
+			/**
+			 * The determinant as det*2^exponent, for matrices whose determinant
+			 * over- or underflows even though its factors do not.
+			 */
+			K determinant(long& exponent) const
+			{
+				K det = K(1);
+				exponent = 0;
+				for(int k=0; k<m_n; k++)
+				{
+					det *= m_u_values[m_u_pointers[k+1]-1];
+					int e;
+					std::frexp(std::abs(det), &e);
+					det *= std::ldexp(1.0, -e);
+					exponent += e;
+				}
+				if(permutation_parity(m_pinv) != permutation_parity(m_q))
+					det = -det;
+				return det;
+			}
+		private:
+			int m_n;
+			std::vector<int> m_q;
+			std::vector<int> m_pinv;
+			double m_pivot_tolerance;
+
+			// L is unit lower triangular with the diagonal stored first in each column,
+			// U is upper triangular with the diagonal stored last in each column.
+			std::vector<int> m_l_pointers, m_l_indices;
+			std::vector<K> m_l_values;
+			std::vector<int> m_u_pointers, m_u_indices;
+			std::vector<K> m_u_values;
+
+			static bool permutation_parity(const std::vector<int>& p)
+			{
+				std::vector<bool> visited(p.size());
+				bool odd = false;
+				for(int i=0; i<p.size(); i++)
+				{
+					if(visited[i])
+						continue;
+					int length = 0;
+					for(int j=i; !visited[j]; j=p[j], length++)
+						visited[j] = true;
+					if(length % 2 == 0)
+						odd = !odd;
+				}
+				return odd;
+			}
+
+			/**
+			 * Computes the nonzero pattern of L\b by a depth first search through
+			 * the graph of L, starting at the nonzeros of column col of A.
+			 * The pattern is stored in topological order in xi[top..n).
+			 * marks uses the generation counter k to avoid clearing it per column.
+			 */
+			int reach(const sparse_matrix<K>& at, int col, int k, std::vector<int>& xi, std::vector<int>& stack,
+				std::vector<int>& positions, std::vector<int>& marks) const
+			{
+				int top = m_n;
+				auto& rp = at.row_pointers();
+				auto& ci = at.column_indices();
+				for(int p=rp[col]; p<rp[col+1]; p++)
+				{
+					int start = ci[p];
+					if(marks[start] == k)
+						continue;
+
+					int head = 0;
+					stack[0] = start;
+					while(head >= 0)
+					{
+						int j = stack[head];
+						int jnew = m_pinv[j];
+						if(marks[j] != k)
+						{
+							marks[j] = k;
+							positions[head] = jnew < 0 ? 0 : m_l_pointers[jnew]+1;
+						}
+
+						bool done = true;
+						int end = jnew < 0 ? 0 : m_l_pointers[jnew+1];
+						for(int q=positions[head]; q<end; q++)
+						{
+							int i = m_l_indices[q];
+							if(marks[i] == k)
+								continue;
+							positions[head] = q+1;
+							stack[++head] = i;
+							done = false;
+							break;
+						}
+						if(done)
+						{
+							head--;
+							xi[--top] = j;
+						}
+					}
+				}
+				return top;
+			}
+
+			void factor(const sparse_matrix<K>& at)
+			{
+				int n = m_n;
+				m_pinv.assign(n, -1);
+				m_l_pointers.assign(1, 0);
+				m_u_pointers.assign(1, 0);
+				m_l_indices.clear(); m_l_values.clear();
+				m_u_indices.clear(); m_u_values.clear();
+				m_l_indices.reserve(4*at.nonzeros() + n);
+				m_l_values.reserve(4*at.nonzeros() + n);
+				m_u_indices.reserve(4*at.nonzeros() + n);
+				m_u_values.reserve(4*at.nonzeros() + n);
+
+				std::vector<K> x(n);
+				std::vector<int> xi(n), stack(n), positions(n), marks(n, -1);
+
+				auto& rp = at.row_pointers();
+				auto& ci = at.column_indices();
+				auto& values = at.values();
+
+				for(int k=0; k<n; k++)
+				{
+					int col = m_q[k];
+
+					// sparse triangular solve x = L\A(:,col)
+					int top = reach(at, col, k, xi, stack, positions, marks);
+					for(int p=top; p<n; p++)
+						x[xi[p]] = K(0);
+					for(int p=rp[col]; p<rp[col+1]; p++)
+						x[ci[p]] = values[p];
+					for(int p=top; p<n; p++)
+					{
+						int j = xi[p];
+						int J = m_pinv[j];
+						if(J < 0)
+							continue;
+						K xj = x[j];
+						for(int q=m_l_pointers[J]+1; q<m_l_pointers[J+1]; q++)
+							x[m_l_indices[q]] -= m_l_values[q] * xj;
+					}
+
+					// choose the pivot and store the column of U
+					int pivot_row = -1;
+					double largest = -1;
+					for(int p=top; p<n; p++)
+					{
+						int i = xi[p];
+						if(m_pinv[i] < 0)
+						{
+							double a = std::abs(x[i]);
+							if(a > largest)
+							{
+								largest = a;
+								pivot_row = i;
+							}
+						}
+						else
+						{
+							m_u_indices.push_back(m_pinv[i]);
+							m_u_values.push_back(x[i]);
+						}
+					}
+					if(pivot_row < 0 || largest <= 0)
+						throw std::logic_error("matrix is singular");
+					if(m_pinv[col] < 0 && marks[col] == k && std::abs(x[col]) >= m_pivot_tolerance*largest)
+						pivot_row = col;
+
+					K pivot = x[pivot_row];
+					m_u_indices.push_back(k);
+					m_u_values.push_back(pivot);
+					m_u_pointers.push_back(m_u_values.size());
+					m_pinv[pivot_row] = k;
+
+					// store the column of L
+					m_l_indices.push_back(pivot_row);
+					m_l_values.push_back(K(1));
+					for(int p=top; p<n; p++)
+					{
+						int i = xi[p];
+						if(m_pinv[i] < 0)
+						{
+							m_l_indices.push_back(i);
+							m_l_values.push_back(x[i] / pivot);
+						}
+					}
+					m_l_pointers.push_back(m_l_values.size());
+				}
+
+				// translate the row indices of L into the permuted numbering
+				for(int& i : m_l_indices)
+					i = m_pinv[i];
+			}
+	};
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "nodal_analysis.hpp"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Hash for maps with std::string keys that can be searched with a
+	 * std::string_view, without constructing a string per lookup.
+	 */
+	struct string_view_hash
+	{
+		using is_transparent = void;
+
+		std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+	};
+
+	/**
+	 * A circuit read from a SPICE netlist, with the names of its nodes.
+	 * The nodes are numbered densely in the order of their first appearance,
+	 * node 0 is ground ("0" or "gnd" in any case).
+	 */
+	class netlist
+	{
+		public:
+			const std::string& title() const { return m_title; }
+
+			circuit& network() { return m_circuit; }
+			const circuit& network() const { return m_circuit; }
+
+			int nodes() const { return m_node_names.size(); }
+			/**
+			 * The number of the node with the given name.
+			 * Throws std::out_of_range if there is no such node.
+			 */
+			int node(std::string_view name) const;
+			const std::string& node_name(int node) const { return m_node_names[node]; }
+			/**
+			 * The index in network() of the element with the given name.
+			 * Only elements with a branch current have their names kept, i.e. the
+			 * sources V, E and H and the inductors, which are the ones that F and H
+			 * can refer to and whose currents are usually asked for.
+			 * Throws std::out_of_range if there is no such element.
+			 */
+			int element(std::string_view name) const;
+		private:
+			std::string m_title;
+			circuit m_circuit;
+			std::vector<std::string> m_node_names;
+			std::unordered_map<std::string, int, string_view_hash, std::equal_to<>> m_nodes;
+			std::unordered_map<std::string, int, string_view_hash, std::equal_to<>> m_elements;
+
+			friend class spice_parser;
+	};
+
+	/**
+	 * Reads a netlist in a subset of the SPICE syntax:
+	 *   - the first line is the title,
+	 *   - lines starting with * are comments, and ; starts a comment up to the end of the line,
+	 *   - lines starting with + continue the previous line,
+	 *   - Rname n1 n2 value, Cname n1 n2 value, Lname n1 n2 value,
+	 *   - Vname n+ n- [[DC] value] [AC magnitude [phase]] and likewise I,
+	 *     where the AC phasor (phase in degrees) takes precedence over the DC value
+	 *     and anything after these, e.g. a transient function, is ignored,
+	 *   - Ename n+ n- nc+ nc- gain and Gname n+ n- nc+ nc- transconductance,
+	 *   - Fname n+ n- vcontrol gain and Hname n+ n- vcontrol transresistance,
+	 *   - .end ends the netlist, other lines starting with . are skipped.
+	 * Element letters, keywords and suffixes are case insensitive, names are not.
+	 * Values are numbers with an optional scale suffix f, p, n, u, m, mil, k, meg,
+	 * g or t; letters after it are units and ignored, so 10pF is 1e-11.
+	 * The text is split into tokens that point into it, so only new node names
+	 * allocate memory.
+	 * Throws std::runtime_error with the line number on a malformed line.
+	 */
+	netlist parse_spice(std::string_view text);
+	/**
+	 * Parses the file at path with parse_spice, mapped into memory instead of read.
+	 */
+	netlist read_spice(const std::string& path);
+}
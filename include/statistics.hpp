@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Mean and variance of a stream of values without storing them, by the
+	 * update of Welford, which does not cancel like summing x and x^2.
+	 * Partial statistics of disjoint parts of a stream can be merged
+	 * (Chan, Golub and LeVeque), e.g. after computing them in parallel.
+	 */
+	class running_statistics
+	{
+		public:
+			void add(double x)
+			{
+				m_count++;
+				double delta = x - m_mean;
+				m_mean += delta / m_count;
+				m_m2 += delta * (x - m_mean);
+				m_min = std::min(m_min, x);
+				m_max = std::max(m_max, x);
+			}
+
+			void merge(const running_statistics& other)
+			{
+				if(other.m_count == 0)
+					return;
+				long count = m_count + other.m_count;
+				double delta = other.m_mean - m_mean;
+				m_mean += delta * other.m_count / count;
+				m_m2 += other.m_m2 + delta*delta * ((double)m_count * other.m_count / count);
+				m_count = count;
+				m_min = std::min(m_min, other.m_min);
+				m_max = std::max(m_max, other.m_max);
+			}
+
+			long count() const { return m_count; }
+			double mean() const { return m_mean; }
+			/**
+			 * The sample variance, i.e. divided by count()-1.
+			 */
+			double variance() const { return m_count > 1 ? m_m2 / (m_count-1) : 0; }
+			double deviation() const { return std::sqrt(variance()); }
+			double min() const { return m_min; }
+			double max() const { return m_max; }
+		private:
+			long m_count = 0;
+			double m_mean = 0;
+			double m_m2 = 0;
+			double m_min = std::numeric_limits<double>::infinity();
+			double m_max = -std::numeric_limits<double>::infinity();
+	};
+
+	/**
+	 * Counts of values in equally wide bins between lower and upper.
+	 * Values outside of the range are only counted as below or above,
+	 * NaN counts as below.
+	 */
+	class histogram
+	{
+		public:
+			histogram(double lower, double upper, int bins) : m_lower(lower), m_upper(upper), m_counts(std::max(bins, 0))
+			{
+				if(!(lower < upper) || bins <= 0)
+					throw std::domain_error("histogram: empty range");
+			}
+
+			void add(double x)
+			{
+				if(!(x >= m_lower))
+					m_below++;
+				else if(x >= m_upper)
+					m_above++;
+				else
+					m_counts[std::min<int>((x - m_lower) / (m_upper - m_lower) * m_counts.size(), m_counts.size()-1)]++;
+			}
+
+			void merge(const histogram& other)
+			{
+				if(other.m_lower != m_lower || other.m_upper != m_upper || other.m_counts.size() != m_counts.size())
+					throw std::logic_error("histogram: bins do not match");
+				for(int i=0; i<m_counts.size(); i++)
+					m_counts[i] += other.m_counts[i];
+				m_below += other.m_below;
+				m_above += other.m_above;
+			}
+
+			double lower() const { return m_lower; }
+			double upper() const { return m_upper; }
+			int bins() const { return m_counts.size(); }
+			/**
+			 * The lower end of a bin.
+			 */
+			double bin(int i) const { return m_lower + (m_upper - m_lower) * i / m_counts.size(); }
+			const std::vector<long>& counts() const { return m_counts; }
+			long below() const { return m_below; }
+			long above() const { return m_above; }
+		private:
+			double m_lower;
+			double m_upper;
+			std::vector<long> m_counts;
+			long m_below = 0;
+			long m_above = 0;
+	};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace unimath
+{
+	/**
+	 * Fixed set of worker threads for data parallel loops.
+	 * Unlike std::async, the threads are started once and reused, so even
+	 * short loops (like one elimination step) can be split across them.
+	 */
+	class thread_pool
+	{
+		public:
+			/**
+			 * Starts threads-1 workers; the calling thread is the last one.
+			 */
+			explicit thread_pool(int threads = std::thread::hardware_concurrency());
+			~thread_pool();
+
+			thread_pool(const thread_pool&) = delete;
+			thread_pool& operator=(const thread_pool&) = delete;
+
+			int size() const { return m_workers.size() + 1; }
+
+			/**
+			 * Calls body(first, last) for disjoint ranges covering [begin, end)
+			 * of at least grain indices each and returns when all of them are done.
+			 * Runs serially if called from inside a parallel_for or while the pool
+			 * is busy with a loop of another thread.
+			 * If body throws, the remaining ranges are skipped and the first
+			 * exception is rethrown once all threads have stopped.
+			 */
+			void parallel_for(int begin, int end, const std::function<void(int, int)>& body, int grain = 1);
+
+			/**
+			 * The pool shared by the library, with one thread per core.
+			 */
+			static thread_pool& shared();
+		private:
+			std::vector<std::thread> m_workers;
+			std::mutex m_submit;
+
+			std::mutex m_mutex;
+			std::condition_variable m_start;
+			std::condition_variable m_done;
+			bool m_stop = false;
+			long m_generation = 0;
+
+			// the current loop
+			const std::function<void(int, int)>* m_body = nullptr;
+			int m_end = 0;
+			int m_chunk = 1;
+			std::atomic<int> m_next;
+			int m_active = 0;
+			std::exception_ptr m_error;
+
+			void work();
+			void run_chunks();
+	};
+}
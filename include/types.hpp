@@ -14,4 +14,19 @@ namespace unimath
 	using C = std::complex<__float>;
 
 	constexpr __float EPSILON = 0.0000001;
+
+	/**
+	 * Complex conjugate that keeps real types real
+	 * (std::conj turns a double into a std::complex<double>).
+	 */
+	template<typename K>
+	K conjugate(const K& k)
+	{
+		return k;
+	}
+	template<typename T>
+	std::complex<T> conjugate(const std::complex<T>& k)
+	{
+		return std::conj(k);
+	}
 }
@@ -0,0 +1,150 @@
+#include "bareiss.hpp"
+
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace unimath
+{
+	static Z bareiss_narrow(__int128 v)
+	{
+		if(v > std::numeric_limits<Z>::max() || v < std::numeric_limits<Z>::min())
+			throw std::overflow_error("bareiss: entry does not fit into integer type");
+		return (Z)v;
+	}
+
+	std::vector<int> bareiss(matrix<Z>& m, int* sign)
+	{
+		int rows = m.rows();
+		int columns = m.columns();
+
+		std::vector<int> pivots;
+		Z previous = 1;
+		int s = 1;
+
+		int row = 0;
+		for(int c=0; c<columns && row<rows; c++)
+		{
+			int r = row;
+			while(r<rows && m(r, c) == 0) r++;
+			if(r == rows)
+				continue;
+
+			if(r != row)
+			{
+				for(int j=0; j<columns; j++)
+					std::swap(m(row, j), m(r, j));
+				s = -s;
+			}
+
+			Z pivot = m(row, c);
+			for(int i=0; i<rows; i++)
+			{
+				if(i == row)
+					continue;
+
+				Z a = m(i, c);
+				for(int j=0; j<columns; j++)
+				{
+					__int128 v = (__int128)pivot * m(i, j) - (__int128)a * m(row, j);
+					m(i, j) = bareiss_narrow(v / previous);
+				}
+			}
+
+			previous = pivot;
+			pivots.push_back(c);
+			row++;
+		}
+
+		if(sign) *sign = s;
+		return pivots;
+	}
+
+	Z bareiss_det(matrix<Z> m)
+	{
+		if(m.rows() != m.columns())
+			throw std::logic_error("matrix is not quadratic");
+		int n = m.rows();
+		if(n == 0)
+			return 1;
+
+		int sign;
+		std::vector<int> pivots = bareiss(m, &sign);
+		if(pivots.size() != n)
+			return 0;
+		return sign * m(n-1, n-1);
+	}
+
+	matrix<Z> integer_rows(const matrix<fraction>& m, std::vector<Z>& scale)
+	{
+		int rows = m.rows();
+		int columns = m.columns();
+
+		std::vector<std::vector<Z>> entries(rows, std::vector<Z>(columns));
+		scale.assign(rows, 1);
+		for(int i=0; i<rows; i++)
+		{
+			Z l = 1;
+			for(int j=0; j<columns; j++)
+				l = bareiss_narrow((__int128)(l / std::gcd(l, m(i, j).denominator())) * m(i, j).denominator());
+			for(int j=0; j<columns; j++)
+				entries[i][j] = bareiss_narrow((__int128)m(i, j).numerator() * (l / m(i, j).denominator()));
+			scale[i] = l;
+		}
+		return matrix<Z>(entries);
+	}
+
+	matrix<fraction> bareiss_nzsf(const matrix<fraction>& m, std::vector<int>* pivots)
+	{
+		std::vector<Z> scale;
+		matrix<Z> work = integer_rows(m, scale);
+		std::vector<int> p = bareiss(work);
+
+		int rows = m.rows();
+		int columns = m.columns();
+		std::vector<std::vector<fraction>> entries(rows, std::vector<fraction>(columns));
+		if(!p.empty())
+		{
+			Z d = work(0, p[0]);
+			for(int i=0; i<p.size(); i++)
+				for(int j=0; j<columns; j++)
+					entries[i][j] = fraction(work(i, j), d);
+		}
+
+		if(pivots) *pivots = p;
+		return matrix<fraction>(entries);
+	}
+
+	fraction bareiss_det(const matrix<fraction>& m)
+	{
+		std::vector<Z> scale;
+		Z det = bareiss_det(integer_rows(m, scale));
+
+		fraction f(det, 1l);
+		for(Z s : scale)
+			f /= fraction(s, 1l);
+		return f;
+	}
+
+	matrix<fraction> bareiss_inverse(const matrix<fraction>& m)
+	{
+		if(m.rows() != m.columns())
+			throw std::logic_error("matrix is not quadratic");
+		int n = m.rows();
+
+		std::vector<Z> scale;
+		matrix<Z> work = concat(integer_rows(m, scale), matrix<Z>::identity(n));
+		std::vector<int> pivots = bareiss(work);
+
+		if(pivots.size() < n || pivots[n-1] != n-1)
+			throw std::logic_error("matrix is not invertible");
+
+		// work = [d*I | d*B^-1] with B = diag(scale)*m, so m^-1 = B^-1 * diag(scale)
+		Z d = work(0, 0);
+		std::vector<std::vector<fraction>> entries(n, std::vector<fraction>(n));
+		for(int i=0; i<n; i++)
+			for(int j=0; j<n; j++)
+				entries[i][j] = fraction(work(i, n+j), d) * fraction(scale[j], 1l);
+		return matrix<fraction>(entries);
+	}
+}
@@ -0,0 +1,146 @@
+#include "big_fraction.hpp"
+#include "render.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace unimath
+{
+	big_fraction::big_fraction(big_integer p, big_integer q) : m_p(std::move(p)), m_q(std::move(q))
+	{
+		if(m_q.is_zero())
+			throw std::domain_error("big_fraction: zero denominator");
+		if(m_q.sign() < 0)
+		{
+			m_p = -m_p;
+			m_q = -m_q;
+		}
+		big_integer g = gcd(m_p, m_q);
+		if(g != 1)
+		{
+			m_p /= g;
+			m_q /= g;
+		}
+	}
+
+	/**
+	 * With d = gcd(q1, q2) the sum p1/q1 + p2/q2 is t/(q1/d * q2) for
+	 * t = p1*(q2/d) + p2*(q1/d), and only gcd(t, d) can still cancel
+	 * (TAOCP 4.5.1).
+	 */
+	big_fraction big_fraction::add(const big_fraction& a, const big_fraction& b, bool subtract)
+	{
+		const big_integer bp = subtract ? -b.m_p : b.m_p;
+		if(a.m_q == b.m_q && a.m_q == 1)
+			return a.m_p + bp;
+
+		big_integer d = gcd(a.m_q, b.m_q);
+		if(d == 1)
+			return big_fraction(a.m_p*b.m_q + bp*a.m_q, a.m_q*b.m_q, reduced());
+
+		big_integer s = a.m_q / d;
+		big_integer t = a.m_p*(b.m_q / d) + bp*s;
+		big_integer e = gcd(t, d);
+		if(e == 1)
+			return big_fraction(std::move(t), s*b.m_q, reduced());
+		return big_fraction(t / e, s*(b.m_q / e), reduced());
+	}
+
+	big_fraction operator+(const big_fraction& a, const big_fraction& b)
+	{
+		return big_fraction::add(a, b, false);
+	}
+	big_fraction operator-(const big_fraction& a, const big_fraction& b)
+	{
+		return big_fraction::add(a, b, true);
+	}
+
+	/**
+	 * Cancels p1 against q2 and p2 against q1 before multiplying, so the
+	 * product is already reduced.
+	 */
+	big_fraction operator*(const big_fraction& a, const big_fraction& b)
+	{
+		if(a.m_p.is_zero() || b.m_p.is_zero())
+			return 0;
+		big_integer g1 = gcd(a.m_p, b.m_q);
+		big_integer g2 = gcd(b.m_p, a.m_q);
+		return big_fraction((a.m_p / g1)*(b.m_p / g2), (a.m_q / g2)*(b.m_q / g1), big_fraction::reduced());
+	}
+
+	big_fraction operator/(const big_fraction& a, const big_fraction& b)
+	{
+		if(b.m_p.is_zero())
+			throw std::domain_error("big_fraction: division by zero");
+		if(a.m_p.is_zero())
+			return 0;
+		big_integer g1 = gcd(a.m_p, b.m_p);
+		big_integer g2 = gcd(b.m_q, a.m_q);
+		big_integer p = (a.m_p / g1)*(b.m_q / g2);
+		big_integer q = (a.m_q / g2)*(b.m_p / g1);
+		if(q.sign() < 0)
+			return big_fraction(-p, -q, big_fraction::reduced());
+		return big_fraction(std::move(p), std::move(q), big_fraction::reduced());
+	}
+
+	std::strong_ordering operator<=>(const big_fraction& a, const big_fraction& b)
+	{
+		if(a.m_q == b.m_q)
+			return a.m_p <=> b.m_p;
+		return a.m_p*b.m_q <=> b.m_p*a.m_q;
+	}
+
+	big_fraction big_fraction::operator-() const
+	{
+		return big_fraction(-m_p, m_q, reduced());
+	}
+
+	static big_integer big_fraction_power_of_two(int exponent)
+	{
+		big_integer result = 1;
+		for(; exponent >= 62; exponent -= 62)
+			result *= big_integer(1l << 62);
+		return result * big_integer(1l << exponent);
+	}
+
+	big_fraction::operator double() const
+	{
+		// keep the leading 64 bits of both parts, so huge values neither overflow nor lose precision
+		int sp = std::max(0, m_p.bit_length() - 64);
+		int sq = std::max(0, m_q.bit_length() - 64);
+		if(sp == 0 && sq == 0)
+			return (double)m_p / (double)m_q;
+		double p = (double)(sp ? m_p / big_fraction_power_of_two(sp) : m_p);
+		double q = (double)(sq ? m_q / big_fraction_power_of_two(sq) : m_q);
+		return std::ldexp(p / q, sp - sq);
+	}
+
+	void render(render_buffer& buffer, const big_fraction& f)
+	{
+		if(buffer.latex() && f.denominator() != 1)
+		{
+			if(f.numerator().sign() < 0)
+				buffer.append('-');
+			buffer.append("\\frac{");
+			render(buffer, f.numerator().sign() < 0 ? -f.numerator() : f.numerator());
+			buffer.append("}{");
+			render(buffer, f.denominator());
+			buffer.append('}');
+		}
+		else if(f.denominator() != 1)
+		{
+			buffer.append('(');
+			render(buffer, f.numerator());
+			buffer.append('/');
+			render(buffer, f.denominator());
+			buffer.append(')');
+		}
+		else
+			render(buffer, f.numerator());
+	}
+
+	std::ostream& operator<<(std::ostream& out, const big_fraction& f)
+	{
+		return render_to(out, f);
+	}
+}
@@ -0,0 +1,487 @@
+#include "big_integer.hpp"
+#include "render.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace unimath
+{
+	using limbs = std::vector<unsigned long>;
+	using u128 = unsigned __int128;
+
+	/**
+	 * Below this many limbs the schoolbook product is faster than Karatsuba.
+	 */
+	static const int karatsuba_threshold = 32;
+
+	static void limbs_trim(limbs& a)
+	{
+		while(!a.empty() && a.back() == 0)
+			a.pop_back();
+	}
+
+	static int limbs_compare(const limbs& a, const limbs& b)
+	{
+		if(a.size() != b.size())
+			return a.size() < b.size() ? -1 : 1;
+		for(int i=a.size()-1; i>=0; i--)
+			if(a[i] != b[i])
+				return a[i] < b[i] ? -1 : 1;
+		return 0;
+	}
+
+	/**
+	 * r += a * 2^(64*shift). r must be large enough for the result.
+	 */
+	static void limbs_add_into(limbs& r, const limbs& a, int shift)
+	{
+		unsigned long carry = 0;
+		int i = 0;
+		for(; i<a.size(); i++)
+		{
+			u128 s = (u128)r[i+shift] + a[i] + carry;
+			r[i+shift] = (unsigned long)s;
+			carry = s >> 64;
+		}
+		for(; carry; i++)
+		{
+			u128 s = (u128)r[i+shift] + carry;
+			r[i+shift] = (unsigned long)s;
+			carry = s >> 64;
+		}
+	}
+
+	/**
+	 * r -= a for r >= a.
+	 */
+	static void limbs_sub_into(limbs& r, const limbs& a)
+	{
+		unsigned long borrow = 0;
+		int i = 0;
+		for(; i<a.size(); i++)
+		{
+			u128 d = (u128)r[i] - a[i] - borrow;
+			r[i] = (unsigned long)d;
+			borrow = (d >> 64) != 0;
+		}
+		for(; borrow; i++)
+		{
+			borrow = r[i] == 0;
+			r[i]--;
+		}
+		limbs_trim(r);
+	}
+
+	static limbs limbs_add(const limbs& a, const limbs& b)
+	{
+		const limbs& longer = a.size() >= b.size() ? a : b;
+		const limbs& shorter = a.size() >= b.size() ? b : a;
+		limbs r = longer;
+		r.push_back(0);
+		limbs_add_into(r, shorter, 0);
+		limbs_trim(r);
+		return r;
+	}
+
+	static limbs limbs_school(const limbs& a, const limbs& b)
+	{
+		limbs r(a.size() + b.size());
+		for(int i=0; i<a.size(); i++)
+		{
+			unsigned long carry = 0;
+			for(int j=0; j<b.size(); j++)
+			{
+				u128 p = (u128)a[i]*b[j] + r[i+j] + carry;
+				r[i+j] = (unsigned long)p;
+				carry = p >> 64;
+			}
+			r[i+b.size()] = carry;
+		}
+		limbs_trim(r);
+		return r;
+	}
+
+	static limbs limbs_slice(const limbs& a, int begin, int end)
+	{
+		limbs r(a.begin() + std::min<int>(begin, a.size()), a.begin() + std::min<int>(end, a.size()));
+		limbs_trim(r);
+		return r;
+	}
+
+	/**
+	 * Karatsuba: with a = a1*B + a0 and b = b1*B + b0,
+	 * a*b = a1*b1*B^2 + ((a0+a1)*(b0+b1) - a0*b0 - a1*b1)*B + a0*b0
+	 * needs three half size products instead of four.
+	 */
+	static limbs limbs_multiply(const limbs& a, const limbs& b)
+	{
+		if(a.empty() || b.empty())
+			return {};
+		if(std::min(a.size(), b.size()) < karatsuba_threshold)
+			return limbs_school(a, b);
+
+		int h = std::max(a.size(), b.size())/2;
+		limbs r(a.size() + b.size() + 1);
+
+		// very unbalanced sizes: only split the longer factor
+		if(b.size() <= h || a.size() <= h)
+		{
+			const limbs& longer = a.size() > b.size() ? a : b;
+			const limbs& shorter = a.size() > b.size() ? b : a;
+			limbs_add_into(r, limbs_multiply(limbs_slice(longer, 0, h), shorter), 0);
+			limbs_add_into(r, limbs_multiply(limbs_slice(longer, h, longer.size()), shorter), h);
+			limbs_trim(r);
+			return r;
+		}
+
+		limbs a0 = limbs_slice(a, 0, h), a1 = limbs_slice(a, h, a.size());
+		limbs b0 = limbs_slice(b, 0, h), b1 = limbs_slice(b, h, b.size());
+		limbs z0 = limbs_multiply(a0, b0);
+		limbs z2 = limbs_multiply(a1, b1);
+		limbs z1 = limbs_multiply(limbs_add(a0, a1), limbs_add(b0, b1));
+		limbs_sub_into(z1, z0);
+		limbs_sub_into(z1, z2);
+
+		limbs_add_into(r, z0, 0);
+		limbs_add_into(r, z1, h);
+		limbs_add_into(r, z2, 2*h);
+		limbs_trim(r);
+		return r;
+	}
+
+	/**
+	 * Knuth's algorithm D (TAOCP 4.3.1) with 64 bit limbs and 128 bit intermediates.
+	 */
+	static void limbs_divide(const limbs& u, const limbs& v, limbs& q, limbs& r)
+	{
+		if(limbs_compare(u, v) < 0)
+		{
+			q.clear();
+			r = u;
+			return;
+		}
+
+		int n = v.size();
+		int m = u.size() - n;
+		q.assign(m+1, 0);
+
+		if(n == 1)
+		{
+			unsigned long rest = 0;
+			for(int i=u.size()-1; i>=0; i--)
+			{
+				u128 current = ((u128)rest << 64) | u[i];
+				q[i] = (unsigned long)(current / v[0]);
+				rest = (unsigned long)(current % v[0]);
+			}
+			limbs_trim(q);
+			r.assign(1, rest);
+			limbs_trim(r);
+			return;
+		}
+
+		// normalize, so the leading limb of the divisor has its top bit set
+		int s = __builtin_clzl(v.back());
+		limbs vn(n), un(u.size()+1);
+		for(int i=n-1; i>0; i--)
+			vn[i] = (v[i] << s) | (s ? v[i-1] >> (64-s) : 0);
+		vn[0] = v[0] << s;
+		un[u.size()] = s ? u.back() >> (64-s) : 0;
+		for(int i=u.size()-1; i>0; i--)
+			un[i] = (u[i] << s) | (s ? u[i-1] >> (64-s) : 0);
+		un[0] = u[0] << s;
+
+		const u128 base = (u128)1 << 64;
+		for(int j=m; j>=0; j--)
+		{
+			u128 numerator = ((u128)un[j+n] << 64) | un[j+n-1];
+			u128 qhat = numerator / vn[n-1];
+			u128 rhat = numerator % vn[n-1];
+			while(qhat >= base || qhat*vn[n-2] > ((rhat << 64) | un[j+n-2]))
+			{
+				qhat--;
+				rhat += vn[n-1];
+				if(rhat >= base)
+					break;
+			}
+
+			// un[j..j+n] -= qhat * vn
+			unsigned long carry = 0, borrow = 0;
+			for(int i=0; i<n; i++)
+			{
+				u128 p = qhat*vn[i] + carry;
+				carry = p >> 64;
+				u128 d = (u128)un[i+j] - (unsigned long)p - borrow;
+				un[i+j] = (unsigned long)d;
+				borrow = (d >> 64) != 0;
+			}
+			u128 d = (u128)un[j+n] - carry - borrow;
+			un[j+n] = (unsigned long)d;
+
+			q[j] = (unsigned long)qhat;
+			if((d >> 64) != 0)
+			{
+				// qhat was one too large, add the divisor back
+				q[j]--;
+				unsigned long c = 0;
+				for(int i=0; i<n; i++)
+				{
+					u128 t = (u128)un[i+j] + vn[i] + c;
+					un[i+j] = (unsigned long)t;
+					c = t >> 64;
+				}
+				un[j+n] += c;
+			}
+		}
+
+		limbs_trim(q);
+		r.assign(n, 0);
+		for(int i=0; i<n; i++)
+			r[i] = (un[i] >> s) | (s ? un[i+1] << (64-s) : 0);
+		limbs_trim(r);
+	}
+
+	/**
+	 * Returns the lowest 64 bits of a >> shift.
+	 */
+	static unsigned long limbs_bits(const limbs& a, int shift)
+	{
+		int limb = shift / 64;
+		int bit = shift % 64;
+		unsigned long low = limb < a.size() ? a[limb] >> bit : 0;
+		unsigned long high = bit && limb+1 < a.size() ? a[limb+1] << (64-bit) : 0;
+		return low | high;
+	}
+
+	big_integer::big_integer(__int128 value) : m_small(0)
+	{
+		if(value >= std::numeric_limits<long>::min() && value <= std::numeric_limits<long>::max())
+		{
+			m_small = value;
+			return;
+		}
+		u128 magnitude = value < 0 ? -(u128)value : (u128)value;
+		*this = from_magnitude({(unsigned long)magnitude, (unsigned long)(magnitude >> 64)}, value < 0);
+	}
+
+	big_integer::big_integer(std::string_view decimal) : m_small(0)
+	{
+		bool negative = false;
+		if(!decimal.empty() && (decimal[0] == '-' || decimal[0] == '+'))
+		{
+			negative = decimal[0] == '-';
+			decimal.remove_prefix(1);
+		}
+		if(decimal.empty())
+			throw std::invalid_argument("big_integer: no digits");
+
+		// 18 digits at a time always fit into a long
+		big_integer value;
+		while(!decimal.empty())
+		{
+			int count = std::min<int>(18, decimal.size());
+			long chunk = 0, scale = 1;
+			for(int i=0; i<count; i++)
+			{
+				char c = decimal[i];
+				if(c < '0' || c > '9')
+					throw std::invalid_argument("big_integer: invalid digit");
+				chunk = chunk*10 + (c - '0');
+				scale *= 10;
+			}
+			value = value*scale + chunk;
+			decimal.remove_prefix(count);
+		}
+		*this = negative ? -value : value;
+	}
+
+	std::vector<unsigned long> big_integer::magnitude() const
+	{
+		if(!is_small())
+			return m_limbs;
+		if(m_small == 0)
+			return {};
+		return {m_small < 0 ? 0ul - (unsigned long)m_small : (unsigned long)m_small};
+	}
+
+	big_integer big_integer::from_magnitude(std::vector<unsigned long> magnitude, bool negative)
+	{
+		limbs_trim(magnitude);
+		big_integer result;
+		if(magnitude.empty())
+			return result;
+		if(magnitude.size() == 1)
+		{
+			unsigned long v = magnitude[0];
+			if(!negative && v <= (unsigned long)std::numeric_limits<long>::max())
+			{
+				result.m_small = v;
+				return result;
+			}
+			if(negative && v <= (unsigned long)std::numeric_limits<long>::max() + 1)
+			{
+				result.m_small = (long)(0ul - v);
+				return result;
+			}
+		}
+		result.m_negative = negative;
+		result.m_limbs = std::move(magnitude);
+		return result;
+	}
+
+	int big_integer::bit_length() const
+	{
+		if(is_small())
+		{
+			unsigned long v = m_small < 0 ? 0ul - (unsigned long)m_small : m_small;
+			return v ? 64 - __builtin_clzl(v) : 0;
+		}
+		return 64*m_limbs.size() - __builtin_clzl(m_limbs.back());
+	}
+
+	big_integer::operator double() const
+	{
+		if(is_small())
+			return m_small;
+		double result = 0;
+		int n = m_limbs.size();
+		int first = std::max(0, n-3);
+		for(int i=n-1; i>=first; i--)
+			result = result*18446744073709551616.0 + m_limbs[i];
+		result = std::ldexp(result, 64*first);
+		return m_negative ? -result : result;
+	}
+
+	std::string big_integer::to_string() const
+	{
+		if(is_small())
+			return std::to_string(m_small);
+
+		// peel off 19 decimal digits at a time
+		const limbs ten19 = {10000000000000000000ul};
+		std::vector<unsigned long> chunks;
+		limbs rest = m_limbs, q, r;
+		while(!rest.empty())
+		{
+			limbs_divide(rest, ten19, q, r);
+			chunks.push_back(r.empty() ? 0 : r[0]);
+			rest.swap(q);
+		}
+
+		std::string result = m_negative ? "-" : "";
+		result += std::to_string(chunks.back());
+		for(int i=chunks.size()-2; i>=0; i--)
+		{
+			std::string digits = std::to_string(chunks[i]);
+			result.append(19 - digits.size(), '0');
+			result += digits;
+		}
+		return result;
+	}
+
+	big_integer big_integer::add(const big_integer& a, const big_integer& b, bool subtract)
+	{
+		bool na = a.sign() < 0;
+		bool nb = (b.sign() < 0) != subtract;
+		limbs ma = a.magnitude(), mb = b.magnitude();
+		if(na == nb)
+			return from_magnitude(limbs_add(ma, mb), na);
+
+		int c = limbs_compare(ma, mb);
+		if(c == 0)
+			return big_integer();
+		if(c > 0)
+		{
+			limbs_sub_into(ma, mb);
+			return from_magnitude(std::move(ma), na);
+		}
+		limbs_sub_into(mb, ma);
+		return from_magnitude(std::move(mb), nb);
+	}
+
+	big_integer big_integer::multiply(const big_integer& a, const big_integer& b)
+	{
+		return from_magnitude(limbs_multiply(a.magnitude(), b.magnitude()), (a.sign() < 0) != (b.sign() < 0));
+	}
+
+	std::strong_ordering big_integer::compare(const big_integer& a, const big_integer& b)
+	{
+		int sa = a.sign(), sb = b.sign();
+		if(sa != sb)
+			return sa <=> sb;
+		int c = limbs_compare(a.magnitude(), b.magnitude());
+		return sa < 0 ? 0 <=> c : c <=> 0;
+	}
+
+	void big_integer::divide(const big_integer& a, const big_integer& b, big_integer& q, big_integer& r)
+	{
+		if(b.is_zero())
+			throw std::domain_error("big_integer: division by zero");
+		limbs mq, mr;
+		limbs_divide(a.magnitude(), b.magnitude(), mq, mr);
+		bool na = a.sign() < 0;
+		q = from_magnitude(std::move(mq), na != (b.sign() < 0));
+		r = from_magnitude(std::move(mr), na);
+	}
+
+	/**
+	 * Lehmer's gcd (TAOCP 4.5.2, algorithm L): the Euclidean steps are simulated
+	 * on the leading 63 bits, and the multi-precision numbers are only updated
+	 * once per batch of steps with the accumulated cofactors.
+	 */
+	big_integer big_integer::lehmer_gcd(big_integer a, big_integer b)
+	{
+		if(a.sign() < 0) a = -a;
+		if(b.sign() < 0) b = -b;
+		if(a < b) std::swap(a, b);
+
+		while(!b.is_zero())
+		{
+			if(a.is_small() && a.m_small != std::numeric_limits<long>::min())
+				return std::gcd(a.m_small, b.m_small);
+
+			int shift = std::max(0, a.bit_length() - 63);
+			limbs ma = a.magnitude(), mb = b.magnitude();
+			__int128 x = limbs_bits(ma, shift), y = limbs_bits(mb, shift);
+			__int128 A = 1, B = 0, C = 0, D = 1;
+			while(y+C != 0 && y+D != 0)
+			{
+				__int128 q = (x+A)/(y+C);
+				if(q != (x+B)/(y+D))
+					break;
+				__int128 t = A - q*C; A = C; C = t;
+				t = B - q*D; B = D; D = t;
+				t = x - q*y; x = y; y = t;
+			}
+
+			if(B == 0)
+			{
+				big_integer t = a % b;
+				a = std::move(b);
+				b = std::move(t);
+			}
+			else
+			{
+				big_integer t = a*big_integer(A) + b*big_integer(B);
+				big_integer w = a*big_integer(C) + b*big_integer(D);
+				a = std::move(t);
+				b = std::move(w);
+			}
+		}
+		return a;
+	}
+
+	void render(render_buffer& buffer, const big_integer& value)
+	{
+		if(value.is_small())
+			buffer.append_integer(value.to_long());
+		else
+			buffer.append(value.to_string());
+	}
+
+	std::ostream& operator<<(std::ostream& out, const big_integer& value)
+	{
+		return render_to(out, value);
+	}
+}
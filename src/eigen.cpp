@@ -0,0 +1,345 @@
+#include "eigen.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace unimath
+{
+	namespace
+	{
+		/**
+		 * Upper Hessenberg form A = Q*H*Q^H of a square matrix, stored row-major.
+		 * Q is kept as the list of Householder vectors.
+		 */
+		struct hessenberg_form
+		{
+			int n;
+			std::vector<C> h;
+			std::vector<std::vector<C>> reflectors;
+
+			C& operator()(int i, int j) { return h[i*n+j]; }
+			C operator()(int i, int j) const { return h[i*n+j]; }
+
+			/**
+			 * Computes x = Q*x.
+			 */
+			void apply_q(std::vector<C>& x) const
+			{
+				for(int k=reflectors.size()-1; k>=0; k--)
+				{
+					auto& v = reflectors[k];
+					C s = 0;
+					for(int i=0; i<v.size(); i++)
+						s += std::conj(v[i]) * x[k+1+i];
+					for(int i=0; i<v.size(); i++)
+						x[k+1+i] -= 2.0 * v[i] * s;
+				}
+			}
+		};
+
+		hessenberg_form hessenberg(const matrix<C>& a)
+		{
+			int n = a.rows();
+			hessenberg_form f{n, std::vector<C>(n*n), {}};
+			for(int i=0; i<n; i++)
+				for(int j=0; j<n; j++)
+					f(i, j) = a(i, j);
+
+			std::vector<C> w(n);
+			for(int k=0; k+2<n; k++)
+			{
+				int m = n-k-1;
+				std::vector<C> v(m);
+				R norm = 0;
+				for(int i=0; i<m; i++)
+				{
+					v[i] = f(k+1+i, k);
+					norm += std::norm(v[i]);
+				}
+				norm = std::sqrt(norm);
+				if(norm == 0)
+				{
+					f.reflectors.push_back(std::vector<C>(m));
+					continue;
+				}
+
+				C alpha = -(std::abs(v[0]) == 0 ? C(1) : v[0]/std::abs(v[0])) * norm;
+				v[0] -= alpha;
+				R vnorm = 0;
+				for(auto& x : v) vnorm += std::norm(x);
+				vnorm = std::sqrt(vnorm);
+				for(auto& x : v) x /= vnorm;
+
+				// H = P*H with P = I - 2*v*v^H, row by row to stay cache friendly
+				std::fill(w.begin(), w.end(), C(0));
+				for(int i=0; i<m; i++)
+				{
+					C vi = std::conj(v[i]);
+					for(int j=k; j<n; j++)
+						w[j] += vi * f(k+1+i, j);
+				}
+				for(int i=0; i<m; i++)
+				{
+					C vi = 2.0 * v[i];
+					for(int j=k; j<n; j++)
+						f(k+1+i, j) -= vi * w[j];
+				}
+				// H = H*P
+				for(int i=0; i<n; i++)
+				{
+					C s = 0;
+					for(int l=0; l<m; l++)
+						s += f(i, k+1+l) * v[l];
+					for(int l=0; l<m; l++)
+						f(i, k+1+l) -= 2.0 * s * std::conj(v[l]);
+				}
+
+				f(k+1, k) = alpha;
+				for(int i=k+2; i<n; i++)
+					f(i, k) = 0;
+				f.reflectors.push_back(std::move(v));
+			}
+			return f;
+		}
+
+		/**
+		 * Computes c and s such that [c s; -conj(s) c] * [x; y] = [r; 0].
+		 */
+		void givens(C x, C y, R& c, C& s)
+		{
+			R ax = std::abs(x);
+			R ay = std::abs(y);
+			if(ay == 0)
+			{
+				c = 1;
+				s = 0;
+				return;
+			}
+			if(ax == 0)
+			{
+				c = 0;
+				s = std::conj(y)/ay;
+				return;
+			}
+			R r = std::hypot(ax, ay);
+			c = ax/r;
+			s = (x/ax) * std::conj(y) / r;
+		}
+
+		std::vector<C> hessenberg_eigenvalues(hessenberg_form h)
+		{
+			int n = h.n;
+			std::vector<C> values(n);
+			const R eps = std::numeric_limits<R>::epsilon();
+			const R tiny = std::numeric_limits<R>::min();
+
+			int hi = n-1;
+			int iterations = 0;
+			int total = 0;
+			while(hi >= 0)
+			{
+				int l = hi;
+				for(; l>0; l--)
+				{
+					R sub = std::abs(h(l, l-1));
+					if(sub <= eps*(std::abs(h(l-1, l-1)) + std::abs(h(l, l))) || sub < tiny)
+					{
+						h(l, l-1) = 0;
+						break;
+					}
+				}
+
+				if(l == hi)
+				{
+					values[hi] = h(hi, hi);
+					hi--;
+					iterations = 0;
+					continue;
+				}
+
+				if(++total > 100*n)
+					throw std::runtime_error("eigen: QR iteration did not converge");
+				iterations++;
+
+				// Wilkinson shift: the eigenvalue of the trailing 2x2 block closer to its last entry
+				C a = h(hi-1, hi-1), b = h(hi-1, hi), c = h(hi, hi-1), d = h(hi, hi);
+				C mu;
+				if(iterations % 10 == 0)
+					mu = d + 0.75*std::abs(c);
+				else
+				{
+					C half = (a-d)/2.0;
+					C root = std::sqrt(half*half + b*c);
+					C mu1 = (a+d)/2.0 + root;
+					C mu2 = (a+d)/2.0 - root;
+					mu = std::abs(mu1-d) < std::abs(mu2-d) ? mu1 : mu2;
+				}
+
+				// implicit single shift QR step on the active block, chasing the bulge down
+				C x = h(l, l) - mu;
+				C y = h(l+1, l);
+				for(int k=l; k<hi; k++)
+				{
+					R cs;
+					C sn;
+					givens(x, y, cs, sn);
+
+					for(int j=std::max(l, k-1); j<=hi; j++)
+					{
+						C t1 = h(k, j), t2 = h(k+1, j);
+						h(k, j) = cs*t1 + sn*t2;
+						h(k+1, j) = -std::conj(sn)*t1 + cs*t2;
+					}
+					for(int i=l; i<=std::min(k+2, hi); i++)
+					{
+						C t1 = h(i, k), t2 = h(i, k+1);
+						h(i, k) = t1*cs + t2*std::conj(sn);
+						h(i, k+1) = -t1*sn + t2*cs;
+					}
+
+					if(k < hi-1)
+					{
+						x = h(k+1, k);
+						y = h(k+2, k);
+					}
+				}
+			}
+			return values;
+		}
+
+		/**
+		 * Finds y with H*y = lambda*y by inverse iteration, using an LU decomposition
+		 * of the Hessenberg matrix H - lambda*I with pivoting between adjacent rows.
+		 * The iteration is kept orthogonal to the vectors in cluster, which belong
+		 * to (nearly) equal eigenvalues.
+		 */
+		std::vector<C> hessenberg_eigenvector(const hessenberg_form& h, C lambda, R scale, int start,
+			const std::vector<const std::vector<C>*>& cluster, std::vector<C>& lu)
+		{
+			int n = h.n;
+			const R eps = std::numeric_limits<R>::epsilon();
+
+			lu = h.h;
+			for(int i=0; i<n; i++)
+				lu[i*n+i] -= lambda;
+
+			std::vector<bool> swapped(n);
+			std::vector<C> multipliers(n);
+			for(int k=0; k<n; k++)
+			{
+				if(k+1 < n && std::abs(lu[(k+1)*n+k]) > std::abs(lu[k*n+k]))
+				{
+					for(int j=k; j<n; j++)
+						std::swap(lu[k*n+j], lu[(k+1)*n+j]);
+					swapped[k] = true;
+				}
+				if(std::abs(lu[k*n+k]) < eps*scale)
+					lu[k*n+k] = eps*scale;
+				if(k+1 < n)
+				{
+					C m = lu[(k+1)*n+k] / lu[k*n+k];
+					multipliers[k] = m;
+					for(int j=k+1; j<n; j++)
+						lu[(k+1)*n+j] -= m*lu[k*n+j];
+				}
+			}
+
+			std::vector<C> y(n);
+			for(int i=0; i<n; i++)
+				y[i] = C(1) + C(start) / C(i+1);
+			for(int iteration=0; iteration<3; iteration++)
+			{
+				for(int k=0; k+1<n; k++)
+				{
+					if(swapped[k])
+						std::swap(y[k], y[k+1]);
+					y[k+1] -= multipliers[k]*y[k];
+				}
+				for(int i=n-1; i>=0; i--)
+				{
+					C s = y[i];
+					for(int j=i+1; j<n; j++)
+						s -= lu[i*n+j]*y[j];
+					y[i] = s / lu[i*n+i];
+				}
+
+				// Q is unitary, so orthogonalizing here keeps the final vectors of a cluster independent
+				for(auto* c : cluster)
+				{
+					C s = 0;
+					for(int i=0; i<n; i++)
+						s += std::conj((*c)[i]) * y[i];
+					for(int i=0; i<n; i++)
+						y[i] -= s * (*c)[i];
+				}
+
+				R norm = 0;
+				for(auto& v : y) norm += std::norm(v);
+				norm = std::sqrt(norm);
+				for(auto& v : y) v /= norm;
+			}
+			return y;
+		}
+	}
+
+	eigen_result eigen(const matrix<C>& a, bool vectors)
+	{
+		if(a.rows() != a.columns())
+			throw std::logic_error("matrix is not quadratic");
+		int n = a.rows();
+
+		hessenberg_form h = hessenberg(a);
+		std::vector<C> values = hessenberg_eigenvalues(h);
+
+		std::sort(values.begin(), values.end(), [](C c1, C c2){
+			if(c1.real() == c2.real())
+				return c1.imag() < c2.imag();
+			return c1.real() < c2.real();
+		});
+
+		eigen_result result{values, {}};
+		if(!vectors)
+			return result;
+
+		R scale = 0;
+		for(auto& v : h.h)
+			scale = std::max(scale, std::abs(v));
+		if(scale == 0)
+			scale = 1;
+
+		std::vector<std::vector<C>> entries(n, std::vector<C>(n));
+		std::vector<std::vector<C>> hvectors(n);
+		std::vector<C> lu;
+		for(int k=0; k<n; k++)
+		{
+			// (nearly) equal eigenvalues are slightly separated and their vectors
+			// orthogonalized, so inverse iteration does not return the same vector for all of them
+			C lambda = values[k];
+			std::vector<const std::vector<C>*> cluster;
+			for(int j=0; j<k; j++)
+			{
+				if(std::abs(values[j] - values[k]) < 1e-10*scale)
+				{
+					lambda += 1e-10*scale;
+					cluster.push_back(&hvectors[j]);
+				}
+			}
+
+			hvectors[k] = hessenberg_eigenvector(h, lambda, scale, k, cluster, lu);
+			std::vector<C> y = hvectors[k];
+			h.apply_q(y);
+			for(int i=0; i<n; i++)
+				entries[i][k] = y[i];
+		}
+		result.vectors = matrix<C>(entries);
+		return result;
+	}
+
+	eigen_result eigen(const matrix<R>& a, bool vectors)
+	{
+		return eigen(matrix<C>(a), vectors);
+	}
+}
@@ -0,0 +1,183 @@
+#include "exact_solve.hpp"
+#include "bareiss.hpp"
+#include "big_integer.hpp"
+#include "lu.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace unimath
+{
+	static big_integer exact_abs(const big_integer& a)
+	{
+		return a.sign() < 0 ? -a : a;
+	}
+
+	/**
+	 * Finds the last convergent of the continued fraction of a/b (b > 0) with a
+	 * denominator of at most bound. If a/b is closer than 1/(2*q^2) to a fraction
+	 * p/q with q <= bound, that fraction is the result (Legendre).
+	 * Returns false if the numerator does not fit into fraction.
+	 */
+	static bool exact_reconstruct(big_integer a, big_integer b, long bound, fraction& result)
+	{
+		big_integer p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+		while(!b.is_zero())
+		{
+			// floor division, the remainder keeps b positive
+			big_integer k, r;
+			big_integer::divide(a, b, k, r);
+			if(r.sign() < 0)
+			{
+				k -= 1;
+				r += b;
+			}
+			big_integer q2 = k*q1 + q0;
+			if(q2 > big_integer(bound))
+				break;
+			big_integer p2 = k*p1 + p0;
+			p0 = std::move(p1);
+			p1 = std::move(p2);
+			q0 = std::move(q1);
+			q1 = std::move(q2);
+			a = std::move(b);
+			b = std::move(r);
+		}
+		if(!p1.is_small())
+			return false;
+		result = fraction(p1.to_long(), q1.to_long());
+		return true;
+	}
+
+	/**
+	 * Checks B*x = c exactly by multiplying x with the common denominator of its entries.
+	 */
+	static bool exact_verify(const matrix<Z>& ib, const std::vector<fraction>& x)
+	{
+		int n = x.size();
+		big_integer l = 1;
+		for(auto& f : x)
+			l = l / gcd(l, f.denominator()) * f.denominator();
+
+		std::vector<big_integer> scaled(n);
+		for(int j=0; j<n; j++)
+			scaled[j] = l / x[j].denominator() * x[j].numerator();
+
+		for(int i=0; i<n; i++)
+		{
+			big_integer s = -l * ib(i, n);
+			for(int j=0; j<n; j++)
+				s += scaled[j] * ib(i, j);
+			if(!s.is_zero())
+				return false;
+		}
+		return true;
+	}
+
+	std::vector<fraction> exact_solve(const matrix<fraction>& a, const std::vector<fraction>& b)
+	{
+		if(a.rows() != a.columns())
+			throw std::logic_error("matrix is not quadratic");
+		if(a.rows() != b.size())
+			throw std::logic_error("right hand side does not match row count");
+		int n = a.rows();
+
+		// [B | c] = diag(scale) * [A | b] with integer entries
+		std::vector<std::vector<fraction>> column(n, std::vector<fraction>(1));
+		for(int i=0; i<n; i++)
+			column[i][0] = b[i];
+		std::vector<Z> scale;
+		matrix<Z> ib = integer_rows(concat(a, matrix<fraction>(column)), scale);
+
+		std::vector<std::vector<double>> entries(n, std::vector<double>(n));
+		for(int i=0; i<n; i++)
+			for(int j=0; j<n; j++)
+				entries[i][j] = ib(i, j);
+		lu_decomposition<double> lu{matrix<double>(entries)};
+
+		// the solution is N/d + B^-1*r/d at all times, with d = 2^exponent
+		std::vector<big_integer> r(n), numerators(n), correction(n), next(n);
+		for(int i=0; i<n; i++)
+			r[i] = ib(i, n);
+		big_integer d = 1;
+		int exponent = 0;
+
+		int shift = 20;
+		std::vector<double> rd(n);
+		std::vector<fraction> x(n);
+		while(true)
+		{
+			big_integer rmax = 0;
+			for(int i=0; i<n; i++)
+			{
+				rd[i] = (double)r[i];
+				rmax = std::max(rmax, exact_abs(r[i]));
+			}
+			if(rmax.is_zero())
+			{
+				for(int i=0; i<n; i++)
+					if(!exact_reconstruct(numerators[i], d, std::numeric_limits<long>::max(), x[i]))
+						throw std::overflow_error("exact_solve: solution does not fit into fraction");
+				return x;
+			}
+
+			lu.solve_in_place(rd);
+
+			// N/d is about |rd|/d off. Once that is far below 1/(2*q^2) for every q that
+			// fits into a long, the failed reconstruction means the solution does not fit.
+			double error = 0;
+			for(int i=0; i<n; i++)
+				error = std::max(error, std::abs(rd[i]));
+			if(error > 0 && exponent - std::ilogb(error) > 2*63 + 8)
+				throw std::overflow_error("exact_solve: solution does not fit into fraction");
+
+			big_integer alpha = 1L << shift;
+			for(int i=0; i<n; i++)
+			{
+				double v = std::ldexp(rd[i], shift);
+				if(!(std::abs(v) < 1e36))
+					throw std::overflow_error("exact_solve: refinement step does not fit into 128 bit");
+				correction[i] = (__int128)std::nearbyint(v);
+			}
+
+			// next residual alpha*r - B*correction, computed exactly
+			big_integer nmax = 0;
+			for(int i=0; i<n; i++)
+			{
+				big_integer s = alpha * r[i];
+				for(int j=0; j<n; j++)
+					s -= correction[j] * ib(i, j);
+				nmax = std::max(nmax, exact_abs(s));
+				next[i] = std::move(s);
+			}
+
+			// the double solve was not accurate enough for this scale
+			if(nmax > rmax * alpha / 2)
+			{
+				if(shift == 1)
+					throw std::logic_error("exact_solve: matrix is too ill-conditioned for double precision");
+				shift /= 2;
+				continue;
+			}
+
+			for(int i=0; i<n; i++)
+				numerators[i] = alpha * numerators[i] + correction[i];
+			d *= alpha;
+			exponent += shift;
+			r.swap(next);
+
+			// a fraction with a denominator q <= 2^((exponent-1)/2) is closer than 1/(2*q^2)
+			// only if it is the solution
+			int half = (exponent-1) / 2;
+			long bound = half >= 63 ? std::numeric_limits<long>::max() : 1L << half;
+			bool complete = true;
+			for(int i=0; i<n && complete; i++)
+				complete = exact_reconstruct(numerators[i], d, bound, x[i]);
+			if(complete && exact_verify(ib, x))
+				return x;
+		}
+	}
+}
@@ -5,6 +5,8 @@
 #include <numbers>
 #include <future>
 #include <iomanip>
+#include <stdexcept>
+#include <utility>
 
 namespace unimath
 {
@@ -161,4 +163,44 @@ namespace unimath
 
 		return ctri_polynom(coeffs, t);
 	}
-}
\ No newline at end of file
+
+	std::vector<std::complex<double>> fft(std::vector<std::complex<double>> x, bool inverse)
+	{
+		int n = x.size();
+		if(n == 0 || (n & (n-1)) != 0)
+			throw std::logic_error("fft: size is not a power of two");
+
+		// bit reversal permutation
+		for(int i=1, j=0; i<n; i++)
+		{
+			int bit = n >> 1;
+			for(; j & bit; bit >>= 1)
+				j ^= bit;
+			j ^= bit;
+			if(i < j)
+				std::swap(x[i], x[j]);
+		}
+
+		for(int length=2; length<=n; length*=2)
+		{
+			double angle = (inverse ? 2 : -2)*std::numbers::pi/length;
+			for(int start=0; start<n; start+=length)
+			{
+				for(int k=0; k<length/2; k++)
+				{
+					// the twiddle factor directly instead of by recurrence, which accumulates rounding errors
+					std::complex<double> w = std::polar(1.0, angle*k);
+					std::complex<double> u = x[start+k];
+					std::complex<double> v = x[start+k+length/2]*w;
+					x[start+k] = u + v;
+					x[start+k+length/2] = u - v;
+				}
+			}
+		}
+
+		if(inverse)
+			for(auto& xi : x)
+				xi /= n;
+		return x;
+	}
+}
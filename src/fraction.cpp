@@ -1,132 +1,269 @@
 #include "fraction.hpp"
 #include "latex.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <compare>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 
 namespace unimath
 {
-	fraction::fraction(int p, int q) : m_p(p), m_q(q)
+	using wide = __int128;
+	using uwide = unsigned __int128;
+
+	static std::atomic<fraction_overflow> fraction_policy = fraction_overflow::raise;
+
+	void fraction::overflow_policy(fraction_overflow policy)
 	{
-		clean();
+		fraction_policy = policy;
 	}
 
-	fraction::fraction(long p, long q) : m_p(p), m_q(q)
+	fraction_overflow fraction::overflow_policy()
 	{
-		clean();
+		return fraction_policy;
 	}
 
-	fraction::fraction(float f)
+	static int fraction_bits(uwide a)
 	{
-		long q;
-		for(q = 1; ((long)f)!=f; q*=10, f*=10);
-
-		m_p = (long)f;
-		m_q = q;
-		clean();
+		unsigned long high = a >> 64;
+		return high ? 128 - __builtin_clzl(high) : (a ? 64 - __builtin_clzl((unsigned long)a) : 0);
 	}
 
-	void fraction::clean()
+	/**
+	 * Writes the value of a finite double as p/q with q a power of two.
+	 * Returns false if q would not fit into 125 bits, i.e. if |f| < 2^-72.
+	 * Values beyond the range of long are returned as an out of range p, so
+	 * that storing them applies the overflow policy.
+	 */
+	static bool fraction_split(double f, wide& p, wide& q)
 	{
-		if(m_p == 0)
+		if(!std::isfinite(f))
+			throw std::domain_error("fraction: not a finite number");
+		q = 1;
+		if(f == 0)
 		{
-			m_q = 1;
-			return;
+			p = 0;
+			return true;
+		}
+		if(std::abs(f) >= 0x1p63)
+		{
+			p = f < 0 ? -((wide)1 << 64) : (wide)1 << 64;
+			return true;
 		}
 
-		long gcd = std::gcd(m_p, m_q);
-		m_p /= gcd;
-		m_q /= gcd;
-
-		if(m_q < 0)
+		int exponent;
+		long mantissa = std::ldexp(std::frexp(f, &exponent), 53);
+		exponent -= 53;
+		if(exponent >= 0)
 		{
-			m_q = -m_q;
-			m_p = -m_p;
+			p = (wide)mantissa << exponent;
+			return true;
 		}
+		int shift = std::min(__builtin_ctzl(fraction_abs(mantissa)), -exponent);
+		mantissa >>= shift;
+		exponent += shift;
+		if(-exponent > 125)
+			return false;
+		p = mantissa;
+		q = (wide)1 << -exponent;
+		return true;
 	}
 
-	bool fraction::operator==(const fraction other) const
-	{
-		return m_p == other.m_p && m_q == other.m_q;
-	}
-	std::strong_ordering fraction::operator<=>(const fraction other) const
+	/**
+	 * Compares a/b < c/d for positive numbers by expanding both into continued
+	 * fractions, which needs no products that could overflow.
+	 */
+	static bool fraction_less(uwide a, uwide b, uwide c, uwide d)
 	{
-		auto p1 = m_p * other.m_q;
-		auto p2 = other.m_p * m_q;
-		return p1 <=> p2;
+		while(true)
+		{
+			uwide qa = a / b, qc = c / d;
+			if(qa != qc)
+				return qa < qc;
+			a %= b;
+			c %= d;
+			if(c == 0)
+				return false;
+			if(a == 0)
+				return true;
+			// a/b < c/d if and only if d/c < b/a
+			std::swap(a, d);
+			std::swap(b, c);
+		}
 	}
 
-	fraction fraction::operator+(const fraction other) const
-	{
-		return {m_p * other.m_q + other.m_p * m_q, m_q * other.m_q};
-	}
-	fraction fraction::operator-(const fraction other) const
+	namespace
 	{
-		return {m_p * other.m_q - other.m_p * m_q, m_q * other.m_q};
-	}
-	fraction fraction::operator*(const fraction other) const
-	{
-		return {m_p * other.m_p, m_q * other.m_q};
-	}
-	fraction fraction::operator/(const fraction other) const
-	{
-		return {m_p * other.m_q, m_q * other.m_p};
+		/**
+		 * Continued fraction expansion of x/y with the last two convergents p1/q1 and p0/q0.
+		 */
+		struct fraction_expansion
+		{
+			wide p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+			wide x, y;
+			bool overflow = false;
+
+			fraction_expansion(wide p, wide q) : x(p), y(q) {}
+
+			/**
+			 * Moves to the next convergent, unless the expansion is complete or
+			 * the denominator of the next convergent would exceed bound.
+			 */
+			bool next(wide bound)
+			{
+				if(y == 0)
+					return false;
+				wide a = x / y;
+				if(x % y != 0 && (x < 0) != (y < 0))
+					a--;
+
+				wide p2, q2;
+				if(__builtin_mul_overflow(a, q1, &q2) || __builtin_add_overflow(q2, q0, &q2) || q2 > bound)
+					return false;
+				if(__builtin_mul_overflow(a, p1, &p2) || __builtin_add_overflow(p2, p0, &p2))
+				{
+					overflow = true;
+					return false;
+				}
+
+				p0 = p1; q0 = q1;
+				p1 = p2; q1 = q2;
+				wide r = x - a*y;
+				x = y;
+				y = r;
+				return true;
+			}
+		};
 	}
 
-	fraction& fraction::operator+=(const fraction other)
+	fraction::fraction(double f)
 	{
-		m_p = m_p * other.m_q + other.m_p * m_q;
-		m_q = m_q * other.m_q;
-		clean();
-		return *this;
+		wide p, q;
+		if(fraction_split(f, p, q))
+		{
+			// doubles hold integers up to 2^53 exactly, so p/q is rounded like f was
+			const wide exact_limit = (wide)1 << 53;
+			fraction_expansion e(p, q);
+			while(e.next(std::numeric_limits<long>::max()))
+			{
+				if(e.y == 0 || (fraction_abs(e.p1) <= exact_limit && e.q1 <= exact_limit && (double)e.p1 / (double)e.q1 == f))
+				{
+					store(e.p1, e.q1);
+					return;
+				}
+			}
+		}
+
+		if(fraction_policy == fraction_overflow::raise)
+			throw std::overflow_error("fraction: no fraction with long denominator converts back to the double");
+		*this = approximate(f, std::numeric_limits<long>::max());
 	}
-	fraction& fraction::operator-=(const fraction other)
+
+	fraction fraction::exact(double f)
 	{
-		m_p = m_p * other.m_q + other.m_p * m_q;
-		m_q = m_q * other.m_q;
-		clean();
-		return *this;
+		wide p, q;
+		if(!fraction_split(f, p, q) || q > std::numeric_limits<long>::max())
+		{
+			if(fraction_policy == fraction_overflow::raise)
+				throw std::overflow_error("fraction: exact value does not fit into long");
+			return approximate(f, std::numeric_limits<long>::max());
+		}
+		fraction result;
+		result.store(p, q);
+		return result;
 	}
-	fraction& fraction::operator*=(const fraction other)
+
+	fraction fraction::approximate(double f, long max_denominator)
 	{
-		m_p = m_p * other.m_p;
-		m_q = m_q * other.m_q;
-		clean();
-		return *this;
+		wide p, q;
+		if(fraction_split(f, p, q))
+			return approximate(p, q, max_denominator);
+		if(max_denominator < 1)
+			throw std::domain_error("fraction: maximal denominator must be positive");
+		// |f| < 2^-72 is closer to 0 than to 1/max_denominator
+		return 0;
 	}
-	fraction& fraction::operator/=(const fraction other)
+
+	/**
+	 * The best approximation is the last convergent within the bound or the
+	 * semiconvergent after it (TAOCP 4.5.3). With the complete quotient x/y,
+	 * their distances to p/q are y/(q*q1) and (x - k*y)/(q*qs).
+	 */
+	fraction fraction::approximate(wide p, wide q, long max_denominator)
 	{
-		m_p = m_p * other.m_q;
-		m_q = m_q * other.m_p;
-		clean();
-		return *this;
+		if(max_denominator < 1)
+			throw std::domain_error("fraction: maximal denominator must be positive");
+
+		fraction_expansion e(p, q);
+		while(e.next(max_denominator));
+
+		fraction result;
+		if(e.y == 0 || e.overflow)
+		{
+			result.store(e.p1, e.q1);
+			return result;
+		}
+
+		wide k = (max_denominator - e.q0) / e.q1;
+		wide ps = e.p0 + k*e.p1;
+		wide qs = e.q0 + k*e.q1;
+		if(k > 0 && fraction_less(e.x - k*e.y, e.y, qs, e.q1))
+			result.store(ps, qs);
+		else
+			result.store(e.p1, e.q1);
+		return result;
 	}
 
-	fraction fraction::operator-() const
+	void fraction::overflow(wide p, wide q)
 	{
-		return {-m_p, m_q};
+		const wide max = std::numeric_limits<long>::max();
+		const wide min = std::numeric_limits<long>::min();
+		if(fraction_policy == fraction_overflow::raise)
+			throw std::overflow_error("fraction: result does not fit into long");
+
+		if(p / q > max || p / q < min)
+		{
+			m_p = p < 0 ? min : max;
+			m_q = 1;
+			return;
+		}
+
+		// drop low bits of both parts until they fit, then reduce what is left
+		int shift = std::max(fraction_bits(fraction_abs(p)), fraction_bits(q)) - 63;
+		p = p < 0 ? -(wide)(fraction_abs(p) >> shift) : p >> shift;
+		q = std::max<wide>(q >> shift, 1);
+		assign(p, q);
 	}
 
-	std::ostream& operator<<(std::ostream& out, const fraction f)
+	void render(render_buffer& buffer, const fraction& f)
 	{
-		if(is_latex(out))
+		if(buffer.latex() && f.m_q != 1)
 		{
-			if(is_one(f.m_q))
-				out << f.m_p;
-			else
-			{
-				if(has_leading_minus(f.m_p))
-					out << "-";
-				out << "\\frac{" << strip_leading_minus(f.m_p) << "}{" << f.m_q << "}";
-			}
+			if(f.m_p < 0)
+				buffer.append('-');
+			buffer.append("\\frac{");
+			buffer.append_integer(f.m_p < 0 ? -f.m_p : f.m_p);
+			buffer.append("}{");
+			buffer.append_integer(f.m_q);
+			buffer.append('}');
 		}
-		else
+		else if(f.m_q != 1)
 		{
-			if(f.m_q == 1)
-				out << f.m_p;
-			else
-				out << "(" << f.m_p << "/" << f.m_q << ")";
+			buffer.append('(');
+			buffer.append_integer(f.m_p);
+			buffer.append('/');
+			buffer.append_integer(f.m_q);
+			buffer.append(')');
 		}
-		return out;
+		else
+			buffer.append_integer(f.m_p);
+	}
+
+	std::ostream& operator<<(std::ostream& out, const fraction f)
+	{
+		return render_to(out, f);
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,82 @@
+#include "mapped_matrix.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace unimath
+{
+	static std::runtime_error mapped_file_error(const std::string& what, const std::string& path)
+	{
+		return std::runtime_error("mapped_file: cannot " + what + " " + path + ": " + std::strerror(errno));
+	}
+
+	mapped_file::mapped_file(const std::string& path, std::size_t size) : m_data(nullptr), m_size(size)
+	{
+		m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if(m_fd < 0)
+			throw mapped_file_error("create", path);
+		if(::ftruncate(m_fd, size) != 0)
+		{
+			::close(m_fd);
+			throw mapped_file_error("resize", path);
+		}
+		map(path, true);
+	}
+
+	mapped_file::mapped_file(const std::string& path, bool writable) : m_data(nullptr)
+	{
+		m_fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+		if(m_fd < 0)
+			throw mapped_file_error("open", path);
+		struct stat s;
+		if(::fstat(m_fd, &s) != 0)
+		{
+			::close(m_fd);
+			throw mapped_file_error("stat", path);
+		}
+		m_size = s.st_size;
+		map(path, writable);
+	}
+
+	void mapped_file::map(const std::string& path, bool writable)
+	{
+		if(m_size == 0)
+			return;
+		void* data = ::mmap(nullptr, m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0);
+		if(data == MAP_FAILED)
+		{
+			::close(m_fd);
+			throw mapped_file_error("map", path);
+		}
+		m_data = static_cast<char*>(data);
+	}
+
+	mapped_file::~mapped_file()
+	{
+		if(m_data)
+			::munmap(m_data, m_size);
+		::close(m_fd);
+	}
+
+	void mapped_file::prefetch(std::size_t offset, std::size_t length) const
+	{
+		// madvise needs a page aligned address
+		static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+		std::size_t begin = offset / page * page;
+		std::size_t end = std::min(offset + length, m_size);
+		if(begin < end)
+			::madvise(m_data + begin, end - begin, MADV_WILLNEED);
+	}
+
+	void mapped_file::sync() const
+	{
+		if(m_data && ::msync(m_data, m_size, MS_SYNC) != 0)
+			throw std::runtime_error(std::string("mapped_file: cannot sync: ") + std::strerror(errno));
+	}
+}
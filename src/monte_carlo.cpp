@@ -0,0 +1,159 @@
+#include "monte_carlo.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+
+namespace unimath
+{
+	monte_carlo::monte_carlo(const circuit& c) : m_circuit(c)
+	{
+	}
+
+	void monte_carlo::tolerance(int element, double relative, tolerance_distribution distribution)
+	{
+		if(element < 0 || element >= m_circuit.elements().size())
+			throw std::out_of_range("monte_carlo: no such element");
+		if(relative < 0)
+			throw std::domain_error("monte_carlo: negative tolerance");
+		if(distribution == tolerance_distribution::uniform && relative >= 1)
+			throw std::domain_error("monte_carlo: uniform tolerance of 100% or more");
+
+		std::erase_if(m_variations, [element](const variation& v) { return v.element == element; });
+		m_variations.push_back({element, relative, distribution});
+	}
+
+	std::vector<tolerance_statistics> monte_carlo::run(double frequency, const std::vector<int>& nodes, long samples,
+		double range, int bins, unsigned long seed) const
+	{
+		for(int node : nodes)
+			if(node < 0 || node >= m_circuit.nodes())
+				throw std::out_of_range("monte_carlo: no such node");
+
+		// the pattern keeps the entries that vanish at this s, e.g. -s*L at DC, so that every sample fits
+		C s(0, 2*std::numbers::pi*frequency);
+		std::vector<C> g, m;
+		sparse_matrix<C> pattern = m_circuit.system_pattern(g, m);
+		std::vector<C> base(pattern.nonzeros()), sources(m_circuit.unknowns());
+		std::vector<bool> varied(m_circuit.elements().size());
+		for(auto& v : m_variations)
+			varied[v.element] = true;
+
+		// the positions of the stamps do not depend on the values, so they are looked up once;
+		// the other elements are summed up into base and sources
+		std::vector<std::vector<int>> positions(m_variations.size());
+		std::vector<sparse_matrix<C>::triplet> entries;
+		for(int e=0; e<varied.size(); e++)
+		{
+			entries.clear();
+			m_circuit.stamp(e, s, entries);
+			if(varied[e])
+			{
+				auto& p = positions[std::find_if(m_variations.begin(), m_variations.end(), [e](const variation& v) { return v.element == e; }) - m_variations.begin()];
+				for(auto& [row, column, value] : entries)
+					p.push_back(pattern.find(row, column));
+			}
+			else
+			{
+				for(auto& [row, column, value] : entries)
+					base[pattern.find(row, column)] += value;
+				m_circuit.excitation(e, sources);
+			}
+		}
+
+		auto& values = pattern.values();
+		for(int k=0; k<values.size(); k++)
+			values[k] = g[k] + s*m[k];
+		std::vector<int> order = minimum_degree(pattern);
+		const sparse_lu<C> symbolic(pattern, order);
+
+		std::vector<C> x = m_circuit.excitation();
+		symbolic.solve_in_place(x);
+		std::vector<tolerance_statistics> result;
+		for(int node : nodes)
+			result.push_back({node == 0 ? C(0) : x[node-1], {}, {}, histogram(-range, range, bins)});
+
+		// the batches are run in rounds of a few per thread and merged in order after each
+		// round, so the memory does not grow with the number of samples
+		long batches = (std::max(samples, 0L) + batch-1) / batch;
+		int round = 4 * thread_pool::shared().size();
+		const std::vector<tolerance_statistics> empty = result;
+		std::vector<std::vector<tolerance_statistics>> partial;
+		for(long offset=0; offset<batches; offset+=round)
+		{
+			int size = std::min<long>(round, batches - offset);
+			partial.assign(size, empty);
+			thread_pool::shared().parallel_for(0, size, [&](int first, int last)
+			{
+				circuit c = m_circuit;
+				sparse_lu<C> lu = symbolic;
+				sparse_matrix<C> a = pattern;
+				std::vector<sparse_matrix<C>::triplet> entries;
+				std::vector<C> x;
+				for(int r=first; r<last; r++)
+				{
+					long b = offset + r;
+					std::seed_seq sequence{seed & 0xffffffff, seed >> 32, (unsigned long)b};
+					std::mt19937_64 random(sequence);
+					auto& statistics = partial[r];
+
+					long count = std::min<long>(batch, samples - b*batch);
+					for(long i=0; i<count; i++)
+					{
+						// only the varied elements are stamped again
+						auto& values = a.values();
+						values = base;
+						x = sources;
+						for(int j=0; j<m_variations.size(); j++)
+						{
+							auto& v = m_variations[j];
+							double factor;
+							if(v.distribution == tolerance_distribution::uniform)
+								factor = std::uniform_real_distribution<double>(1 - v.relative, 1 + v.relative)(random);
+							else
+							{
+								do
+									factor = std::normal_distribution<double>(1, v.relative/3)(random);
+								while(factor <= 0);
+							}
+							c.value(v.element, m_circuit.elements()[v.element].value * factor);
+
+							entries.clear();
+							c.stamp(v.element, s, entries);
+							for(int k=0; k<entries.size(); k++)
+								values[positions[j][k]] += std::get<2>(entries[k]);
+							c.excitation(v.element, x);
+						}
+
+						if(!lu.refactor(a))
+							lu = sparse_lu<C>(a, order);
+						lu.solve_in_place(x);
+
+						for(int k=0; k<nodes.size(); k++)
+						{
+							C v = nodes[k] == 0 ? C(0) : x[nodes[k]-1];
+							double magnitude = std::abs(v);
+							double reference = std::abs(statistics[k].nominal);
+							statistics[k].magnitude.add(magnitude);
+							statistics[k].phase.add(std::arg(v));
+							statistics[k].deviation.add(reference == 0 ? magnitude : magnitude/reference - 1);
+						}
+					}
+				}
+			});
+
+			for(auto& statistics : partial)
+			{
+				for(int k=0; k<nodes.size(); k++)
+				{
+					result[k].magnitude.merge(statistics[k].magnitude);
+					result[k].phase.merge(statistics[k].phase);
+					result[k].deviation.merge(statistics[k].deviation);
+				}
+			}
+		}
+		return result;
+	}
+}
@@ -0,0 +1,315 @@
+#include "multimodular.hpp"
+#include "thread_pool.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace unimath
+{
+	using u64 = unsigned long;
+	using u128 = unsigned __int128;
+
+	namespace
+	{
+		/**
+		 * The 16 largest primes below 2^62.
+		 */
+		const u64 multimodular_primes[] = {
+			0x3fffffffffffffc7, 0x3fffffffffffffa9, 0x3fffffffffffff8b, 0x3fffffffffffff71,
+			0x3fffffffffffff67, 0x3fffffffffffff59, 0x3fffffffffffff55, 0x3fffffffffffff3d,
+			0x3fffffffffffff35, 0x3ffffffffffffeef, 0x3ffffffffffffee1, 0x3ffffffffffffec3,
+			0x3ffffffffffffe45, 0x3ffffffffffffe1d, 0x3ffffffffffffe11, 0x3ffffffffffffdc1
+		};
+		const int multimodular_prime_count = sizeof(multimodular_primes)/sizeof(u64);
+
+		/**
+		 * Arithmetic modulo an odd prime p < 2^62 using Montgomery reduction with R = 2^64,
+		 * so products never need a 128 bit division.
+		 * Values are kept in normal form; only the factor of a product is converted,
+		 * since montgomery(x*R, y) = x*y mod p.
+		 */
+		struct montgomery_field
+		{
+			u64 p;
+			u64 p_inverse; // -p^-1 mod 2^64
+			u64 r2; // 2^128 mod p
+
+			montgomery_field(u64 p) : p(p)
+			{
+				u64 inverse = p;
+				for(int i=0; i<6; i++)
+					inverse *= 2 - p*inverse;
+				p_inverse = -inverse;
+				r2 = (u64)(((u128)1 << 64) % p);
+				r2 = (u64)((u128)r2 * r2 % p);
+			}
+
+			/**
+			 * Computes t/R mod p for t < p*R.
+			 */
+			u64 reduce(u128 t) const
+			{
+				u64 m = (u64)t * p_inverse;
+				u64 r = (u64)((t + (u128)m * p) >> 64);
+				return r >= p ? r-p : r;
+			}
+
+			u64 to_montgomery(u64 x) const { return reduce((u128)x * r2); }
+			u64 multiply(u64 x, u64 y) const { return reduce((u128)to_montgomery(x) * y); }
+
+			u64 inverse(u64 x) const
+			{
+				// Fermat: x^(p-2)
+				u64 result = to_montgomery(1);
+				u64 base = to_montgomery(x);
+				for(u64 e=p-2; e; e>>=1)
+				{
+					if(e & 1)
+						result = reduce((u128)result * base);
+					base = reduce((u128)base * base);
+				}
+				return reduce(result);
+			}
+
+			u64 from(Z v) const
+			{
+				long r = v % (long)p;
+				return r < 0 ? r + p : r;
+			}
+		};
+
+		struct modular_elimination
+		{
+			int rank;
+			u64 determinant;
+		};
+
+		/**
+		 * Gaussian elimination modulo p, returning the rank and the determinant
+		 * (the latter only meaningful for quadratic matrices).
+		 * The residues of m are reduced into a, which is reused between calls.
+		 */
+		modular_elimination multimodular_eliminate(const matrix<Z>& m, u64 p, std::vector<u64>& a)
+		{
+			montgomery_field f(p);
+			int rows = m.rows();
+			int columns = m.columns();
+
+			a.resize(rows*columns);
+			for(int i=0; i<rows; i++)
+				for(int j=0; j<columns; j++)
+					a[i*columns+j] = f.from(m(i, j));
+
+			u64 det = 1;
+			bool negative = false;
+			int row = 0;
+			for(int c=0; c<columns && row<rows; c++)
+			{
+				int r = row;
+				while(r<rows && a[r*columns+c] == 0) r++;
+				if(r == rows)
+				{
+					det = 0;
+					continue;
+				}
+				if(r != row)
+				{
+					for(int j=c; j<columns; j++)
+						std::swap(a[row*columns+j], a[r*columns+j]);
+					negative = !negative;
+				}
+
+				u64* pivot_row = &a[row*columns];
+				det = f.multiply(det, pivot_row[c]);
+				u64 inverse = f.inverse(pivot_row[c]);
+				for(int i=row+1; i<rows; i++)
+				{
+					u64* current = &a[i*columns];
+					if(current[c] == 0)
+						continue;
+					// current -= factor * pivot_row, with the factor in Montgomery form
+					u64 factor = f.to_montgomery(p - f.multiply(current[c], inverse));
+					for(int j=c; j<columns; j++)
+					{
+						u64 v = current[j] + f.reduce((u128)factor * pivot_row[j]);
+						current[j] = v >= p ? v-p : v;
+					}
+				}
+				row++;
+			}
+
+			if(row < rows)
+				det = 0;
+			if(negative && det != 0)
+				det = p - det;
+			return {row, det};
+		}
+
+		/**
+		 * Deterministic Miller-Rabin test, the bases suffice for all n < 2^64.
+		 */
+		bool multimodular_is_prime(u64 n)
+		{
+			if(n < 2)
+				return false;
+			for(u64 p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37})
+				if(n % p == 0)
+					return n == p;
+
+			u64 d = n-1;
+			int s = __builtin_ctzl(d);
+			d >>= s;
+			for(u64 a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37})
+			{
+				u64 x = 1, base = a;
+				for(u64 e=d; e; e>>=1)
+				{
+					if(e & 1)
+						x = (u128)x * base % n;
+					base = (u128)base * base % n;
+				}
+				if(x == 1 || x == n-1)
+					continue;
+				bool composite = true;
+				for(int r=1; r<s && composite; r++)
+				{
+					x = (u128)x * x % n;
+					composite = x != n-1;
+				}
+				if(composite)
+					return false;
+			}
+			return true;
+		}
+
+		/**
+		 * The largest primes below 2^62, as many as are needed for their product to exceed 2^bits.
+		 * The table above is continued by searching further down.
+		 */
+		std::vector<u64> multimodular_primes_for(double bits)
+		{
+			std::vector<u64> primes;
+			double product = 0;
+			for(int k=0; product <= bits; k++)
+			{
+				if(k < multimodular_prime_count)
+					primes.push_back(multimodular_primes[k]);
+				else
+				{
+					u64 candidate = primes.back() - 2;
+					while(!multimodular_is_prime(candidate))
+						candidate -= 2;
+					primes.push_back(candidate);
+				}
+				product += std::log2((double)primes.back());
+			}
+			return primes;
+		}
+
+		/**
+		 * Eliminates m modulo the given primes in parallel on thread_pool::shared().
+		 * Every thread reduces m into one buffer of residues at a time, so the memory
+		 * does not grow with the number of primes.
+		 */
+		std::vector<modular_elimination> multimodular_run(const matrix<Z>& m, const std::vector<u64>& primes)
+		{
+			std::vector<modular_elimination> results(primes.size());
+			thread_pool::shared().parallel_for(0, primes.size(), [&](int first, int last)
+			{
+				std::vector<u64> residues;
+				for(int k=first; k<last; k++)
+					results[k] = multimodular_eliminate(m, primes[k], residues);
+			});
+			return results;
+		}
+
+		/**
+		 * log2 of the product of the euclidean norms of all rows with norm at least 1,
+		 * which bounds the absolute value of every minor.
+		 */
+		double multimodular_hadamard(const matrix<Z>& m)
+		{
+			double bound = 0;
+			for(int i=0; i<m.rows(); i++)
+			{
+				long double norm = 0;
+				for(int j=0; j<m.columns(); j++)
+					norm += (long double)m(i, j) * m(i, j);
+				if(norm > 1)
+					bound += 0.5*std::log2(norm);
+			}
+			// some slack for the rounding of the logarithms
+			return bound * (1 + 1e-12) + 1e-6;
+		}
+	}
+
+	big_integer multimodular_det(const matrix<Z>& m)
+	{
+		if(m.rows() != m.columns())
+			throw std::logic_error("matrix is not quadratic");
+		if(m.rows() == 0)
+			return 1;
+
+		for(int i=0; i<m.rows(); i++)
+		{
+			bool zero = true;
+			for(int j=0; j<m.columns() && zero; j++)
+				zero = m(i, j) == 0;
+			if(zero)
+				return 0;
+		}
+
+		// the residues determine the symmetric representative in (-M/2, M/2], so M > 2*bound is needed
+		std::vector<u64> primes = multimodular_primes_for(multimodular_hadamard(m) + 1);
+		int count = primes.size();
+		auto results = multimodular_run(m, primes);
+
+		// Garner's algorithm with symmetric mixed radix digits, so that
+		// d_0 + p_0*(d_1 + p_1*(d_2 + ...)) is the symmetric representative
+		std::vector<u64> digits(count);
+		std::vector<long> signed_digits(count);
+		for(int k=0; k<count; k++)
+		{
+			montgomery_field f(primes[k]);
+			u64 p = f.p;
+
+			// the number given by the digits found so far and their radix, modulo p
+			u64 current = 0;
+			u64 product = 1;
+			for(int j=0; j<k; j++)
+			{
+				u64 digit = signed_digits[j] < 0 ? f.from(signed_digits[j]) : digits[j] % p;
+				u64 v = current + f.multiply(digit, product);
+				current = v >= p ? v-p : v;
+				product = f.multiply(product, primes[j] % p);
+			}
+
+			u64 difference = results[k].determinant >= current ? results[k].determinant - current : results[k].determinant + p - current;
+			digits[k] = f.multiply(difference, f.inverse(product));
+			signed_digits[k] = digits[k] > p/2 ? -(long)(p - digits[k]) : (long)digits[k];
+		}
+
+		big_integer value = signed_digits[count-1];
+		for(int k=count-2; k>=0; k--)
+			value = value * big_integer((long)primes[k]) + big_integer(signed_digits[k]);
+		return value;
+	}
+
+	int multimodular_rank(const matrix<Z>& m)
+	{
+		int maximum = std::min(m.rows(), m.columns());
+		if(maximum == 0)
+			return 0;
+
+		int rank = 0;
+		for(auto& result : multimodular_run(m, multimodular_primes_for(multimodular_hadamard(m))))
+			rank = std::max(rank, result.rank);
+		return rank;
+	}
+
+	int multimodular_nullity(const matrix<Z>& m)
+	{
+		return m.columns() - multimodular_rank(m);
+	}
+}
@@ -0,0 +1,488 @@
+#include "nodal_analysis.hpp"
+#include "fourier.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace unimath
+{
+	int circuit::add(element e, bool branch)
+	{
+		if(e.a < 0 || e.b < 0 || e.c < 0 || e.d < 0)
+			throw std::out_of_range("circuit: negative node number");
+		if(e.control >= 0 && (e.control >= m_elements.size() || m_elements[e.control].branch < 0))
+			throw std::logic_error("circuit: controlling element has no branch current");
+
+		m_nodes = std::max({m_nodes, e.a+1, e.b+1, e.c+1, e.d+1});
+		if(branch)
+			e.branch = m_branches++;
+		m_elements.push_back(e);
+		return m_elements.size()-1;
+	}
+
+	int circuit::resistor(int a, int b, double resistance)
+	{
+		if(resistance == 0)
+			throw std::domain_error("circuit: resistor without resistance");
+		return add({element_type::resistor, a, b, 0, 0, resistance}, false);
+	}
+
+	int circuit::capacitor(int a, int b, double capacitance)
+	{
+		return add({element_type::capacitor, a, b, 0, 0, capacitance}, false);
+	}
+
+	int circuit::inductor(int a, int b, double inductance)
+	{
+		return add({element_type::inductor, a, b, 0, 0, inductance}, true);
+	}
+
+	int circuit::voltage_source(int a, int b, C voltage)
+	{
+		return add({element_type::voltage_source, a, b, 0, 0, voltage}, true);
+	}
+
+	int circuit::current_source(int a, int b, C current)
+	{
+		return add({element_type::current_source, a, b, 0, 0, current}, false);
+	}
+
+	int circuit::vcvs(int a, int b, int c, int d, double gain)
+	{
+		return add({element_type::vcvs, a, b, c, d, gain}, true);
+	}
+
+	int circuit::vccs(int a, int b, int c, int d, double transconductance)
+	{
+		return add({element_type::vccs, a, b, c, d, transconductance}, false);
+	}
+
+	int circuit::cccs(int a, int b, int control, double gain)
+	{
+		return add({element_type::cccs, a, b, 0, 0, gain, control}, false);
+	}
+
+	int circuit::ccvs(int a, int b, int control, double transresistance)
+	{
+		return add({element_type::ccvs, a, b, 0, 0, transresistance, control}, true);
+	}
+
+	void circuit::value(int element, C value)
+	{
+		if(element < 0 || element >= m_elements.size())
+			throw std::out_of_range("circuit: no such element");
+		if(m_elements[element].type == element_type::resistor && value == 0.0)
+			throw std::domain_error("circuit: resistor without resistance");
+		m_elements[element].value = value;
+	}
+
+	namespace
+	{
+		/**
+		 * Collects the stamps of all elements as triplets. Ground rows and
+		 * columns are dropped, node k is unknown k-1 and branch k is unknown
+		 * nodes()-1+k.
+		 */
+		class mna_stamper
+		{
+			public:
+				mna_stamper(int nodes, std::vector<sparse_matrix<C>::triplet>& entries) : m_nodes(nodes), m_entries(entries)
+				{
+				}
+
+				void add(int row, int column, C value)
+				{
+					if(row >= 0 && column >= 0)
+						m_entries.push_back({row, column, value});
+				}
+				int node(int n) const { return n-1; }
+				int branch(int k) const { return m_nodes-1+k; }
+
+				/**
+				 * Admittance y between the nodes a and b.
+				 */
+				void admittance(int a, int b, C y)
+				{
+					add(node(a), node(a), y);
+					add(node(b), node(b), y);
+					add(node(a), node(b), -y);
+					add(node(b), node(a), -y);
+				}
+				/**
+				 * Current y*V(c, d) flowing from a to b.
+				 */
+				void transadmittance(int a, int b, int c, int d, C y)
+				{
+					add(node(a), node(c), y);
+					add(node(a), node(d), -y);
+					add(node(b), node(c), -y);
+					add(node(b), node(d), y);
+				}
+				/**
+				 * The branch current k flows from a to b, and its row starts with V(a, b).
+				 */
+				void branch(int a, int b, int k)
+				{
+					add(node(a), branch(k), 1);
+					add(node(b), branch(k), -1);
+					add(branch(k), node(a), 1);
+					add(branch(k), node(b), -1);
+				}
+			private:
+				int m_nodes;
+				std::vector<sparse_matrix<C>::triplet>& m_entries;
+		};
+	}
+
+	void circuit::stamp(int element, C s, std::vector<sparse_matrix<C>::triplet>& entries) const
+	{
+		if(element < 0 || element >= m_elements.size())
+			throw std::out_of_range("circuit: no such element");
+		mna_stamper stamp(m_nodes, entries);
+		auto& e = m_elements[element];
+		switch(e.type)
+		{
+			case element_type::resistor:
+				stamp.admittance(e.a, e.b, 1.0/e.value);
+				break;
+			case element_type::capacitor:
+				stamp.admittance(e.a, e.b, s*e.value);
+				break;
+			case element_type::inductor:
+				// V(a, b) - s*L*I = 0
+				stamp.branch(e.a, e.b, e.branch);
+				stamp.add(stamp.branch(e.branch), stamp.branch(e.branch), -s*e.value);
+				break;
+			case element_type::voltage_source:
+				stamp.branch(e.a, e.b, e.branch);
+				break;
+			case element_type::current_source:
+				break;
+			case element_type::vcvs:
+				// V(a, b) - gain*V(c, d) = 0
+				stamp.branch(e.a, e.b, e.branch);
+				stamp.add(stamp.branch(e.branch), stamp.node(e.c), -e.value);
+				stamp.add(stamp.branch(e.branch), stamp.node(e.d), e.value);
+				break;
+			case element_type::vccs:
+				stamp.transadmittance(e.a, e.b, e.c, e.d, e.value);
+				break;
+			case element_type::cccs:
+			{
+				int control = stamp.branch(m_elements[e.control].branch);
+				stamp.add(stamp.node(e.a), control, e.value);
+				stamp.add(stamp.node(e.b), control, -e.value);
+				break;
+			}
+			case element_type::ccvs:
+				// V(a, b) - r*I(control) = 0
+				stamp.branch(e.a, e.b, e.branch);
+				stamp.add(stamp.branch(e.branch), stamp.branch(m_elements[e.control].branch), -e.value);
+				break;
+		}
+	}
+
+	void circuit::stamp(C s, std::vector<sparse_matrix<C>::triplet>& entries) const
+	{
+		entries.reserve(entries.size() + 4*m_elements.size());
+		for(int k=0; k<m_elements.size(); k++)
+			stamp(k, s, entries);
+	}
+
+	sparse_matrix<C> circuit::system_matrix(C s) const
+	{
+		std::vector<sparse_matrix<C>::triplet> entries;
+		stamp(s, entries);
+		int n = unknowns();
+		return sparse_matrix<C>(n, n, std::move(entries));
+	}
+
+	sparse_matrix<C> circuit::system_pattern(std::vector<C>& g, std::vector<C>& m) const
+	{
+		// every stamp is linear in s, and both calls emit the same positions in the same order
+		std::vector<sparse_matrix<C>::triplet> at0, at1, ones;
+		stamp(0, at0);
+		stamp(1, at1);
+		ones.reserve(at0.size());
+		for(auto& [row, column, value] : at0)
+			ones.push_back({row, column, 1});
+
+		int n = unknowns();
+		sparse_matrix<C> pattern(n, n, std::move(ones));
+		g.assign(pattern.nonzeros(), 0);
+		m.assign(pattern.nonzeros(), 0);
+		for(int k=0; k<at0.size(); k++)
+		{
+			auto& [row, column, value] = at0[k];
+			int p = pattern.find(row, column);
+			g[p] += value;
+			m[p] += std::get<2>(at1[k]) - value;
+		}
+		return pattern;
+	}
+
+	void circuit::excitation(int element, std::vector<C>& b, double weight) const
+	{
+		if(element < 0 || element >= m_elements.size())
+			throw std::out_of_range("circuit: no such element");
+		auto& e = m_elements[element];
+		if(e.type == element_type::voltage_source)
+			b[m_nodes-1+e.branch] += weight*e.value;
+		else if(e.type == element_type::current_source)
+		{
+			// the current leaves a and enters b
+			if(e.a > 0)
+				b[e.a-1] -= weight*e.value;
+			if(e.b > 0)
+				b[e.b-1] += weight*e.value;
+		}
+	}
+
+	std::vector<C> circuit::excitation() const
+	{
+		std::vector<C> b(unknowns());
+		for(int k=0; k<m_elements.size(); k++)
+			excitation(k, b);
+		return b;
+	}
+
+	ac_solution circuit::solution(C s, const std::vector<C>& x) const
+	{
+		std::vector<C> voltages(m_nodes);
+		for(int i=1; i<m_nodes; i++)
+			voltages[i] = x[i-1];
+
+		std::vector<C> currents(m_elements.size());
+		for(int k=0; k<m_elements.size(); k++)
+		{
+			auto& e = m_elements[k];
+			C v = voltages[e.a] - voltages[e.b];
+			switch(e.type)
+			{
+				case element_type::resistor:
+					currents[k] = v / e.value;
+					break;
+				case element_type::capacitor:
+					currents[k] = s*e.value*v;
+					break;
+				case element_type::current_source:
+					currents[k] = e.value;
+					break;
+				case element_type::vccs:
+					currents[k] = e.value*(voltages[e.c] - voltages[e.d]);
+					break;
+				case element_type::cccs:
+					currents[k] = e.value*x[m_nodes-1+m_elements[e.control].branch];
+					break;
+				default:
+					currents[k] = x[m_nodes-1+e.branch];
+					break;
+			}
+		}
+		return ac_solution(std::move(voltages), std::move(currents));
+	}
+
+	ac_solution circuit::solve(double frequency) const
+	{
+		C s(0, 2*std::numbers::pi*frequency);
+		std::vector<C> x = excitation();
+		sparse_lu<C>(system_matrix(s)).solve_in_place(x);
+		return solution(s, x);
+	}
+
+	/**
+	 * Drops the real and imaginary parts of a that are below tolerance times its largest value.
+	 */
+	static void transfer_clean(std::vector<C>& a, double tolerance)
+	{
+		double largest = 0;
+		for(auto& x : a)
+			largest = std::max(largest, std::abs(x));
+		for(auto& x : a)
+			x = C(std::abs(x.real()) < tolerance*largest ? 0 : x.real(), std::abs(x.imag()) < tolerance*largest ? 0 : x.imag());
+	}
+
+	/**
+	 * Turns the values a_j = c_j*radius^j of a polynom into its coefficients c_j,
+	 * divided by divisor*radius^degree.
+	 */
+	static polynom transfer_polynom(std::vector<C> a, double radius, C divisor, int degree)
+	{
+		for(int j=0; j<a.size(); j++)
+		{
+			a[j] = a[j] / divisor * std::pow(radius, degree-j);
+			// no negative zeros in the output
+			a[j] = C(a[j].real() + 0.0, a[j].imag() + 0.0);
+		}
+		return polynom(std::move(a), false);
+	}
+
+	std::tuple<polynom, polynom> circuit::transfer_function(int node, double tolerance) const
+	{
+		if(node <= 0 || node >= m_nodes)
+			throw std::out_of_range("circuit: no such node");
+
+		int reactive = std::count_if(m_elements.begin(), m_elements.end(), [](const element& e)
+		{
+			return e.type == element_type::capacitor || e.type == element_type::inductor;
+		});
+		int n = 1;
+		while(n <= reactive)
+			n *= 2;
+
+		std::vector<C> g, m;
+		sparse_matrix<C> a = system_pattern(g, m);
+		std::vector<int> order = minimum_degree(a);
+		std::vector<C> b = excitation();
+
+		/*
+		 * Samples N and D at s_k = radius*e^(i pi (2k+1)/n), between the roots of
+		 * unity so that poles on the axes cannot be hit, and returns a_j = c_j*radius^j.
+		 * p(s_k) = sum_j a_j e^(i pi j/n) e^(2 pi i jk/n) is a DFT of the rotated a_j.
+		 */
+		auto interpolate = [&](double radius, std::vector<C>& numerator, std::vector<C>& denominator)
+		{
+			numerator.assign(n, 0);
+			denominator.assign(n, 0);
+			std::vector<long> exponents(n);
+			for(int k=0; k<n; k++)
+			{
+				C s = std::polar(radius, (2*k+1)*std::numbers::pi/n);
+				auto& values = a.values();
+				for(int p=0; p<values.size(); p++)
+					values[p] = g[p] + s*m[p];
+				sparse_lu<C> lu(a, order);
+				denominator[k] = lu.determinant(exponents[k]);
+				std::vector<C> x = b;
+				lu.solve_in_place(x);
+				numerator[k] = denominator[k]*x[node-1];
+			}
+			long largest = *std::max_element(exponents.begin(), exponents.end());
+			for(int k=0; k<n; k++)
+			{
+				double scale = std::ldexp(1.0, exponents[k]-largest);
+				numerator[k] *= scale;
+				denominator[k] *= scale;
+			}
+
+			numerator = fft(numerator);
+			denominator = fft(denominator);
+			for(int j=0; j<n; j++)
+			{
+				C rotation = std::polar(1.0/n, -j*std::numbers::pi/n);
+				numerator[j] *= rotation;
+				denominator[j] *= rotation;
+			}
+		};
+		// first guess: the geometric mean of the frequencies at which the diagonal entries of G and s*M balance
+		double logarithms = 0;
+		int count = 0;
+		for(int i=0; i<a.rows(); i++)
+		{
+			int p = a.find(i, i);
+			if(p >= 0 && std::abs(g[p]) > 0 && std::abs(m[p]) > 0)
+			{
+				logarithms += std::log(std::abs(g[p]) / std::abs(m[p]));
+				count++;
+			}
+		}
+		double radius = count > 0 ? std::exp(logarithms/count) : 1;
+
+		// at the geometric mean of the roots of D its lowest and highest terms balance,
+		// which needs a few rounds if the first guess hides some terms below the tolerance
+		std::vector<C> numerator, denominator;
+		int high;
+		for(int round=0; ; round++)
+		{
+			interpolate(radius, numerator, denominator);
+			transfer_clean(denominator, tolerance);
+			high = n-1;
+			while(high > 0 && denominator[high] == 0.0)
+				high--;
+			int low = 0;
+			while(low < high && denominator[low] == 0.0)
+				low++;
+			if(denominator[high] == 0.0)
+				throw std::logic_error("circuit: the system is singular at every frequency");
+			double factor = low < high ? std::pow(std::abs(denominator[low]) / std::abs(denominator[high]), 1.0/(high-low)) : 1;
+			if(round == 8 || (factor > 0.5 && factor < 2))
+				break;
+			radius *= factor;
+		}
+		transfer_clean(numerator, tolerance);
+
+		C leading = denominator[high];
+		return {
+			transfer_polynom(std::move(numerator), radius, leading, high),
+			transfer_polynom(std::move(denominator), radius, leading, high)
+		};
+	}
+
+	ac_sweep::ac_sweep(const circuit& c) : m_circuit(c)
+	{
+		m_pattern = m_circuit.system_pattern(m_g, m_m);
+		m_b = m_circuit.excitation();
+		m_order = minimum_degree(m_pattern);
+	}
+
+	void ac_sweep::sweep(const std::vector<double>& frequencies, const std::function<void(int, C, const std::vector<C>&)>& consume) const
+	{
+		if(frequencies.empty())
+			return;
+
+		auto fill = [this](sparse_matrix<C>& a, C s)
+		{
+			auto& values = a.values();
+			for(int k=0; k<values.size(); k++)
+				values[k] = m_g[k] + s*m_m[k];
+		};
+		auto laplace = [](double frequency) { return C(0, 2*std::numbers::pi*frequency); };
+
+		// the pivot sequence of a frequency from the middle of the sweep
+		sparse_matrix<C> reference = m_pattern;
+		fill(reference, laplace(frequencies[frequencies.size()/2]));
+		const sparse_lu<C> symbolic(reference, m_order);
+
+		thread_pool::shared().parallel_for(0, frequencies.size(), [&](int first, int last)
+		{
+			sparse_lu<C> lu = symbolic;
+			sparse_matrix<C> a = m_pattern;
+			std::vector<C> x;
+			for(int i=first; i<last; i++)
+			{
+				C s = laplace(frequencies[i]);
+				fill(a, s);
+				if(!lu.refactor(a))
+					lu = sparse_lu<C>(a, m_order);
+				x = m_b;
+				lu.solve_in_place(x);
+				consume(i, s, x);
+			}
+		}, 16);
+	}
+
+	void ac_sweep::run(const std::vector<double>& frequencies, const std::function<void(int, const ac_solution&)>& callback) const
+	{
+		sweep(frequencies, [&](int i, C s, const std::vector<C>& x)
+		{
+			callback(i, m_circuit.solution(s, x));
+		});
+	}
+
+	void ac_sweep::run(const std::vector<double>& frequencies, const std::vector<int>& nodes, C* out) const
+	{
+		for(int node : nodes)
+			if(node < 0 || node >= m_circuit.nodes())
+				throw std::out_of_range("ac_sweep: no such node");
+
+		int count = frequencies.size();
+		sweep(frequencies, [&](int i, C, const std::vector<C>& x)
+		{
+			for(int k=0; k<nodes.size(); k++)
+				out[(long)k*count + i] = nodes[k] == 0 ? C(0) : x[nodes[k]-1];
+		});
+	}
+}
@@ -216,14 +216,14 @@ namespace unimath
 		}
 	}
 
-	std::ostream& operator<<(std::ostream& out, const polynom& p)
+	void render(render_buffer& buffer, const polynom& p)
 	{
-		if(is_latex(out))
+		if(buffer.latex())
 		{
 			if(p.deg() == -1)
 			{
-				out << "0";
-				return out;
+				buffer.append('0');
+				return;
 			}
 
 			for(int i=p.m_coefficients.size()-1; i>=0; i--)
@@ -236,48 +236,70 @@ namespace unimath
 					if(c.real() < 0 && c.imag() == 0)
 					{
 						if(c.real() == -1 && i > 0)
-							out << " - ";
-						else	
-							out << " - " << -c.real() << " ";
+							buffer.append(" - ");
+						else
+						{
+							buffer.append(" - ");
+							render(buffer, -c.real());
+							buffer.append(' ');
+						}
 					}
 					else
 					{
-						out << " + ";
-						if(p.m_coefficients[i] != 1.0 || i==0)
-							out << p.m_coefficients[i] << " ";
+						buffer.append(" + ");
+						if(c != 1.0 || i==0)
+						{
+							render(buffer, c);
+							buffer.append(' ');
+						}
 					}
 				}
 				else
 				{
-					if(p.m_coefficients[i] != 1.0 || i==0)
-						out << p.m_coefficients[i] << " ";
+					if(c != 1.0 || i==0)
+					{
+						render(buffer, c);
+						buffer.append(' ');
+					}
 				}
-				
+
 				if(i == 1)
-					out << "z";
+					buffer.append('z');
 				if(i > 1)
-					out << "z^{" << i << "}";
+				{
+					buffer.append("z^{");
+					buffer.append_integer(i);
+					buffer.append('}');
+				}
 			}
 		}
 		else
 		{
-			out << "[";
+			buffer.append('[');
 			if(p.deg() == -1)
 			{
-				out << "0]";
-				return out;
+				buffer.append("0]");
+				return;
 			}
 			for(int i=p.m_coefficients.size()-1; i>=0; i--)
 			{
-				out << p.m_coefficients[i];
+				render(buffer, p.m_coefficients[i]);
 				if(i == 1)
-					out << "z + ";
+					buffer.append("z + ");
 				if(i > 1)
-					out << "z^" << i << " + ";
+				{
+					buffer.append("z^");
+					buffer.append_integer(i);
+					buffer.append(" + ");
+				}
 			}
-			out << "]";
+			buffer.append(']');
 		}
-		return out;
+	}
+
+	std::ostream& operator<<(std::ostream& out, const polynom& p)
+	{
+		return render_to(out, p);
 	}
 
 	std::tuple<polynom, std::vector<partial_fraction>> complex_pfd(polynom p, polynom q, __float epsilon)
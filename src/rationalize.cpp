@@ -0,0 +1,32 @@
+#include "rationalize.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace unimath
+{
+	template<typename F>
+	static matrix<fraction> rationalize_rows(const matrix<double>& m, F convert)
+	{
+		matrix<fraction> result(m.rows(), m.columns());
+		// a few thousand conversions per task outweigh the scheduling
+		int grain = std::max(1, 4096 / std::max(1, m.columns()));
+		thread_pool::shared().parallel_for(0, m.rows(), [&](int first, int last)
+		{
+			for(int i=first; i<last; i++)
+				for(int j=0; j<m.columns(); j++)
+					result(i, j) = convert(m(i, j));
+		}, grain);
+		return result;
+	}
+
+	matrix<fraction> rationalize(const matrix<double>& m)
+	{
+		return rationalize_rows(m, [](double f) { return fraction(f); });
+	}
+
+	matrix<fraction> rationalize(const matrix<double>& m, long max_denominator)
+	{
+		return rationalize_rows(m, [max_denominator](double f) { return fraction::approximate(f, max_denominator); });
+	}
+}
@@ -0,0 +1,78 @@
+#include "render.hpp"
+#include "latex.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace unimath
+{
+	void render_buffer::reset(std::ostream& out)
+	{
+		m_text.clear();
+		m_stream = &out;
+		m_latex = is_latex(out);
+
+		auto flags = out.flags();
+		auto field = flags & std::ios_base::floatfield;
+		if(field == std::ios_base::fixed)
+			m_format = std::chars_format::fixed;
+		else if(field == std::ios_base::scientific)
+			m_format = std::chars_format::scientific;
+		else if(field == (std::ios_base::fixed | std::ios_base::scientific))
+			m_format = std::chars_format::hex;
+		else
+			m_format = std::chars_format::general;
+
+		// %g treats a precision of 0 like 1, which to_chars does as well
+		m_precision = out.precision();
+		m_stream_only = flags & (std::ios_base::showpos | std::ios_base::showpoint | std::ios_base::uppercase);
+	}
+
+	void render_buffer::write(std::ostream& out) const
+	{
+		std::streamsize padding = out.width() - (std::streamsize)m_text.size();
+		out.width(0);
+		if(padding <= 0)
+		{
+			out.write(m_text.data(), m_text.size());
+			return;
+		}
+
+		// internal has no sign to pad after for a whole field, so it pads left like right
+		std::string fill(padding, out.fill());
+		if((out.flags() & std::ios_base::adjustfield) == std::ios_base::left)
+		{
+			out.write(m_text.data(), m_text.size());
+			out.write(fill.data(), fill.size());
+		}
+		else
+		{
+			out.write(fill.data(), fill.size());
+			out.write(m_text.data(), m_text.size());
+		}
+	}
+
+	namespace
+	{
+		struct render_pool
+		{
+			std::vector<std::unique_ptr<render_buffer>> buffers;
+			int used = 0;
+		};
+
+		thread_local render_pool pool;
+	}
+
+	render_lease::render_lease(std::ostream& out)
+	{
+		if(pool.used == pool.buffers.size())
+			pool.buffers.push_back(std::make_unique<render_buffer>());
+		m_buffer = pool.buffers[pool.used++].get();
+		m_buffer->reset(out);
+	}
+
+	render_lease::~render_lease()
+	{
+		pool.used--;
+	}
+}
@@ -0,0 +1,364 @@
+#include "spice.hpp"
+#include "mapped_matrix.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+
+namespace unimath
+{
+	static bool spice_equal(std::string_view a, std::string_view b)
+	{
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+		{
+			return (x | 0x20) == (y | 0x20);
+		});
+	}
+
+	static bool spice_starts_with(std::string_view a, std::string_view prefix)
+	{
+		return a.size() >= prefix.size() && spice_equal(a.substr(0, prefix.size()), prefix);
+	}
+
+	int netlist::node(std::string_view name) const
+	{
+		if(name == "0" || spice_equal(name, "gnd"))
+			return 0;
+		auto it = m_nodes.find(name);
+		if(it == m_nodes.end())
+			throw std::out_of_range("netlist: no node " + std::string(name));
+		return it->second;
+	}
+
+	int netlist::element(std::string_view name) const
+	{
+		auto it = m_elements.find(name);
+		if(it == m_elements.end())
+			throw std::out_of_range("netlist: no element " + std::string(name));
+		return it->second;
+	}
+
+	/**
+	 * Splits the text into cards, i.e. lines with their continuation lines,
+	 * and the cards into tokens.
+	 */
+	class spice_parser
+	{
+		public:
+			spice_parser(std::string_view text, netlist& result) : m_text(text), m_result(result)
+			{
+			}
+
+			void parse()
+			{
+				m_result.m_title = trim(next_line());
+				m_result.m_node_names.push_back("0");
+				m_result.m_nodes.emplace("0", 0);
+				// about one element per line, and rarely more nodes than elements
+				int lines = std::count(m_text.begin(), m_text.end(), '\n');
+				m_result.m_circuit.reserve(lines);
+				m_result.m_nodes.reserve(lines);
+
+				while(next_card())
+				{
+					if(m_tokens.empty())
+						continue;
+					std::string_view name = m_tokens[0];
+					char type = name[0] | 0x20;
+					if(type == '.')
+					{
+						if(spice_equal(name, ".end"))
+							break;
+						continue;
+					}
+
+					// in this order, so that nodes are numbered by their appearance
+					int a = node(1);
+					int b = node(2);
+					// circuit rejects invalid values, e.g. a zero resistance, without a line
+					try
+					{
+						switch(type)
+						{
+							case 'r':
+								m_result.m_circuit.resistor(a, b, value(3));
+								break;
+							case 'c':
+								m_result.m_circuit.capacitor(a, b, value(3));
+								break;
+							case 'l':
+								named(m_result.m_circuit.inductor(a, b, value(3)));
+								break;
+							case 'v':
+								named(m_result.m_circuit.voltage_source(a, b, source()));
+								break;
+							case 'i':
+								m_result.m_circuit.current_source(a, b, source());
+								break;
+							case 'e':
+							case 'g':
+							{
+								int c = node(3);
+								int d = node(4);
+								if(type == 'e')
+									named(m_result.m_circuit.vcvs(a, b, c, d, value(5)));
+								else
+									m_result.m_circuit.vccs(a, b, c, d, value(5));
+								break;
+							}
+							case 'f':
+							case 'h':
+								// the controlling source may come later in the netlist
+								m_controlled.push_back({type, a, b, std::string(token(3)), value(4), m_card_line, std::string(name)});
+								break;
+							default:
+								error("unsupported element " + std::string(name));
+						}
+					}
+					catch(const std::logic_error& e)
+					{
+						error(e.what());
+					}
+				}
+
+				// an H can control an F or H, so add them in rounds
+				while(!m_controlled.empty())
+				{
+					auto ready = std::partition(m_controlled.begin(), m_controlled.end(), [this](const controlled& c)
+					{
+						return !m_result.m_elements.contains(c.control);
+					});
+					if(ready == m_controlled.end())
+					{
+						m_card_line = m_controlled.front().line;
+						error("unknown controlling source " + m_controlled.front().control);
+					}
+					for(auto it=ready; it!=m_controlled.end(); it++)
+					{
+						m_card_line = it->line;
+						int control = m_result.m_elements.find(it->control)->second;
+						try
+						{
+							if(it->type == 'f')
+								m_result.m_circuit.cccs(it->a, it->b, control, it->gain);
+							else
+							{
+								int index = m_result.m_circuit.ccvs(it->a, it->b, control, it->gain);
+								if(!m_result.m_elements.emplace(it->name, index).second)
+									error("duplicate element " + it->name);
+							}
+						}
+						catch(const std::logic_error& e)
+						{
+							error(e.what());
+						}
+					}
+					m_controlled.erase(ready, m_controlled.end());
+				}
+			}
+		private:
+			struct controlled
+			{
+				char type;
+				int a, b;
+				std::string control;
+				double gain;
+				int line;
+				std::string name;
+			};
+
+			std::string_view m_text;
+			std::size_t m_position = 0;
+			int m_line = 0;
+			int m_card_line = 0;
+			netlist& m_result;
+			std::vector<std::string_view> m_tokens;
+			std::vector<controlled> m_controlled;
+
+			[[noreturn]] void error(const std::string& what) const
+			{
+				throw std::runtime_error("spice: line " + std::to_string(m_card_line) + ": " + what);
+			}
+
+			static std::string_view trim(std::string_view s)
+			{
+				while(!s.empty() && (s.back() == '\r' || s.back() == ' ' || s.back() == '\t'))
+					s.remove_suffix(1);
+				while(!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+					s.remove_prefix(1);
+				return s;
+			}
+
+			std::string_view next_line()
+			{
+				std::size_t end = m_text.find('\n', m_position);
+				if(end == std::string_view::npos)
+					end = m_text.size();
+				std::string_view line = m_text.substr(m_position, end - m_position);
+				m_position = std::min(end+1, m_text.size());
+				m_line++;
+				return line;
+			}
+
+			void split(std::string_view line)
+			{
+				std::size_t i = 0;
+				while(i < line.size())
+				{
+					char c = line[i];
+					if(c == ';')
+						break;
+					if(c == ' ' || c == '\t' || c == '\r' || c == ',' || c == '(' || c == ')' || c == '=')
+					{
+						i++;
+						continue;
+					}
+					std::size_t start = i;
+					while(i < line.size() && !std::strchr(" \t\r,()=;", line[i]))
+						i++;
+					m_tokens.push_back(line.substr(start, i - start));
+				}
+			}
+
+			/**
+			 * Reads the next card into m_tokens, returns false at the end of the text.
+			 */
+			bool next_card()
+			{
+				m_tokens.clear();
+				while(m_position < m_text.size())
+				{
+					std::string_view line = next_line();
+					if(line.empty() || line[0] == '*')
+						continue;
+					m_card_line = m_line;
+					split(line);
+					while(m_position < m_text.size() && m_text[m_position] == '+')
+					{
+						m_position++;
+						split(next_line());
+					}
+					return true;
+				}
+				return false;
+			}
+
+			std::string_view token(int i) const
+			{
+				if(i >= m_tokens.size())
+					error("missing field " + std::to_string(i+1) + " of " + std::string(m_tokens[0]));
+				return m_tokens[i];
+			}
+
+			int node(int i)
+			{
+				std::string_view name = token(i);
+				if(name == "0" || spice_equal(name, "gnd"))
+					return 0;
+				auto it = m_result.m_nodes.find(name);
+				if(it != m_result.m_nodes.end())
+					return it->second;
+				int index = m_result.m_node_names.size();
+				m_result.m_node_names.emplace_back(name);
+				m_result.m_nodes.emplace(name, index);
+				return index;
+			}
+
+			bool number(std::string_view s, double& result) const
+			{
+				const char* first = s.data();
+				const char* last = s.data() + s.size();
+				if(first != last && *first == '+')
+					first++;
+				auto [end, error] = std::from_chars(first, last, result);
+				if(error != std::errc())
+					return false;
+
+				std::string_view suffix(end, last - end);
+				if(spice_starts_with(suffix, "meg"))
+					result *= 1e6;
+				else if(spice_starts_with(suffix, "mil"))
+					result *= 25.4e-6;
+				else if(!suffix.empty())
+				{
+					switch(suffix[0] | 0x20)
+					{
+						case 'f': result *= 1e-15; break;
+						case 'p': result *= 1e-12; break;
+						case 'n': result *= 1e-9; break;
+						case 'u': result *= 1e-6; break;
+						case 'm': result *= 1e-3; break;
+						case 'k': result *= 1e3; break;
+						case 'g': result *= 1e9; break;
+						case 't': result *= 1e12; break;
+					}
+				}
+				return true;
+			}
+
+			double value(int i) const
+			{
+				double result;
+				if(!number(token(i), result))
+					error("invalid value " + std::string(m_tokens[i]));
+				return result;
+			}
+
+			C source() const
+			{
+				double dc = 0;
+				C ac;
+				bool has_ac = false;
+				int i = 3;
+				double v;
+				if(i < m_tokens.size() && number(m_tokens[i], v))
+				{
+					dc = v;
+					i++;
+				}
+				while(i < m_tokens.size())
+				{
+					if(spice_equal(m_tokens[i], "dc"))
+					{
+						dc = value(i+1);
+						i += 2;
+					}
+					else if(spice_equal(m_tokens[i], "ac"))
+					{
+						double magnitude = value(i+1), phase = 0;
+						i += 2;
+						if(i < m_tokens.size() && number(m_tokens[i], phase))
+							i++;
+						ac = std::polar(magnitude, phase*std::numbers::pi/180);
+						has_ac = true;
+					}
+					else
+						break;
+				}
+				return has_ac ? ac : C(dc);
+			}
+
+			void named(int index)
+			{
+				if(!m_result.m_elements.emplace(m_tokens[0], index).second)
+					error("duplicate element " + std::string(m_tokens[0]));
+			}
+	};
+
+	netlist parse_spice(std::string_view text)
+	{
+		netlist result;
+		spice_parser(text, result).parse();
+		return result;
+	}
+
+	netlist read_spice(const std::string& path)
+	{
+		mapped_file file(path, false);
+		file.prefetch(0, file.size());
+		return parse_spice(std::string_view(file.data(), file.size()));
+	}
+}
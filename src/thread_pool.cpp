@@ -0,0 +1,112 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace unimath
+{
+	static thread_local bool inside_parallel_for = false;
+
+	thread_pool::thread_pool(int threads) : m_next(0)
+	{
+		for(int i=1; i<threads; i++)
+			m_workers.emplace_back([this](){ work(); });
+	}
+
+	thread_pool::~thread_pool()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop = true;
+		}
+		m_start.notify_all();
+		for(auto& worker : m_workers)
+			worker.join();
+	}
+
+	thread_pool& thread_pool::shared()
+	{
+		static thread_pool pool;
+		return pool;
+	}
+
+	void thread_pool::run_chunks()
+	{
+		bool outer = inside_parallel_for;
+		inside_parallel_for = true;
+		try
+		{
+			while(true)
+			{
+				int first = m_next.fetch_add(m_chunk);
+				if(first >= m_end)
+					break;
+				(*m_body)(first, std::min(first + m_chunk, m_end));
+			}
+		}
+		catch(...)
+		{
+			// skip the remaining chunks and rethrow in the calling thread
+			m_next = m_end;
+			std::lock_guard lock(m_mutex);
+			if(!m_error)
+				m_error = std::current_exception();
+		}
+		inside_parallel_for = outer;
+	}
+
+	void thread_pool::work()
+	{
+		long seen = 0;
+		while(true)
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_start.wait(lock, [&](){ return m_stop || m_generation != seen; });
+				if(m_stop)
+					return;
+				seen = m_generation;
+			}
+
+			run_chunks();
+
+			std::lock_guard lock(m_mutex);
+			if(--m_active == 0)
+				m_done.notify_one();
+		}
+	}
+
+	void thread_pool::parallel_for(int begin, int end, const std::function<void(int, int)>& body, int grain)
+	{
+		if(begin >= end)
+			return;
+
+		int count = end - begin;
+		std::unique_lock submit(m_submit, std::try_to_lock);
+		if(inside_parallel_for || m_workers.empty() || count <= grain || !submit.owns_lock())
+		{
+			body(begin, end);
+			return;
+		}
+
+		// a few chunks per thread, so uneven rows still balance out
+		int chunk = std::max(grain, (count + 4*size() - 1) / (4*size()));
+		{
+			std::lock_guard lock(m_mutex);
+			m_body = &body;
+			m_end = end;
+			m_chunk = chunk;
+			m_next = begin;
+			m_active = m_workers.size();
+			m_generation++;
+		}
+		m_start.notify_all();
+
+		run_chunks();
+
+		std::unique_lock lock(m_mutex);
+		m_done.wait(lock, [&](){ return m_active == 0; });
+		if(m_error)
+			std::rethrow_exception(std::exchange(m_error, nullptr));
+	}
+}
@@ -0,0 +1,31 @@
+#include "bareiss.hpp"
+#include "fraction.hpp"
+#include "matrix.hpp"
+
+#include <iostream>
+
+int main()
+{
+	unimath::matrix<unimath::fraction> m({
+		{1, 0, 9, 5, 7},
+		{0, 2, 1, 3, 1},
+		{1, 5, 8, 9, 0},
+		{7, 0, 1, 7, 4},
+		{9, 4, 3, 1, 6}
+	});
+
+	std::cout << "det = " << unimath::bareiss_det(m) << std::endl;
+
+	auto inv = unimath::bareiss_inverse(m);
+	std::cout << inv << std::endl;
+	std::cout << inv * m << std::endl;
+
+	unimath::matrix<unimath::fraction> n({
+		{{1, 2}, 3, 1, {2, 3}},
+		{1, 6, 2, {4, 3}},
+		{{3, 2}, 9, 0, 2}
+	});
+	std::vector<int> pivots;
+	std::cout << unimath::bareiss_nzsf(n, &pivots) << std::endl;
+	std::cout << "rank = " << pivots.size() << std::endl;
+}
@@ -0,0 +1,60 @@
+#include "big_fraction.hpp"
+#include "matrix.hpp"
+
+#include <iostream>
+
+using unimath::big_fraction;
+using unimath::big_integer;
+
+big_integer power(big_integer base, int exponent)
+{
+	big_integer result = 1;
+	for(; exponent; exponent /= 2, base *= base)
+		if(exponent % 2)
+			result *= base;
+	return result;
+}
+
+int main()
+{
+	big_integer factorial = 1;
+	for(int i=2; i<=50; i++)
+		factorial *= i;
+	std::cout << "50! = " << factorial << std::endl;
+	std::cout << "50!/48! = " << factorial / big_integer("12413915592536072670862289047373375038521486354677760000000000") << std::endl;
+
+	// Karatsuba sized operands, checked through division
+	big_integer a = power(3, 5000) + 12345;
+	big_integer b = power(7, 3000) - 1;
+	big_integer q, r;
+	big_integer::divide(a*b + 999, b, q, r);
+	std::cout << "division " << (q == a && r == 999 ? "ok" : "wrong") << std::endl;
+	big_integer::divide(-a*b - 5, b, q, r);
+	std::cout << "negative division " << (q == -a && r == -5 ? "ok" : "wrong") << std::endl;
+	std::cout << "parsing " << (big_integer(a.to_string()) == a ? "ok" : "wrong") << std::endl;
+	std::cout << "3^5000 * 3^5000 " << (power(3, 5000)*power(3, 5000) == power(3, 10000) ? "ok" : "wrong") << std::endl;
+
+	std::cout << "gcd = " << gcd(power(2, 300)*power(3, 5)*7, power(2, 100)*power(3, 20)*5) << " = " << power(2, 100)*243 << std::endl;
+	std::cout << "2^64 = " << power(2, 64) << ", -2^63 = " << -power(2, 63) << std::endl;
+
+	// exact inverse of a Hilbert matrix, far beyond what fits into a long
+	int n = 12;
+	std::vector<std::vector<big_fraction>> h(n, std::vector<big_fraction>(n));
+	for(int i=0; i<n; i++)
+		for(int j=0; j<n; j++)
+			h[i][j] = big_fraction(1, i+j+1);
+	unimath::matrix<big_fraction> hilbert(h);
+	auto inverse = hilbert.inverse();
+	std::cout << "inverse(0, 0) = " << inverse(0, 0) << ", inverse(11, 11) = " << inverse(11, 11) << std::endl;
+	unimath::matrix<big_fraction> product = hilbert*inverse;
+	bool identity = true;
+	for(int i=0; i<n; i++)
+		for(int j=0; j<n; j++)
+			identity = identity && product(i, j) == (i == j ? 1 : 0);
+	std::cout << "H * inverse(H) " << (identity ? "is" : "is not") << " the identity" << std::endl;
+
+	big_fraction harmonic = 0;
+	for(int i=1; i<=100; i++)
+		harmonic += big_fraction(1, i);
+	std::cout << "H(100) = " << harmonic << " ~ " << (double)harmonic << std::endl;
+}
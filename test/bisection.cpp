@@ -1,18 +1,18 @@
-#include "fraction.hpp"
+#include "big_fraction.hpp"
 
 #include <iostream>
 
 int main()
 {
-	const unimath::fraction target = 2;
+	const unimath::big_fraction target = 2;
 
-	unimath::fraction a = 0;
-	unimath::fraction b = 2;
+	unimath::big_fraction a = 0;
+	unimath::big_fraction b = 2;
 
-	for(;;)
+	for(int step = 0; step < 100; step++)
 	{
-		unimath::fraction mid = (a+b)/2;
-		unimath::fraction midsq = mid*mid;
+		unimath::big_fraction mid = (a+b)/2;
+		unimath::big_fraction midsq = mid*mid;
 
 		std::cout << a  << " " << b << " | " << mid << " = " << midsq << std::endl;
 
@@ -21,4 +21,6 @@ int main()
 		else
 		 	b = mid;
 	}
-}
\ No newline at end of file
+
+	std::cout << (double)a << std::endl;
+}
@@ -0,0 +1,42 @@
+#include "eigen.hpp"
+#include "matrix.hpp"
+
+#include <iostream>
+
+int main()
+{
+	// mass-spring chain with three masses
+	unimath::matrix<double> k({
+		{ 2, -1,  0},
+		{-1,  2, -1},
+		{ 0, -1,  2}
+	});
+
+	auto [values, vectors] = unimath::eigen(k, true);
+	for(auto v : values)
+		std::cout << v << " ";
+	std::cout << std::endl;
+	std::cout << *vectors << std::endl;
+
+	// rotation by 90 degrees: eigenvalues +-i
+	unimath::matrix<double> r({
+		{0, -1},
+		{1,  0}
+	});
+	for(auto v : unimath::eigen(r).values)
+		std::cout << v << " ";
+	std::cout << std::endl;
+
+	using namespace std::complex_literals;
+	unimath::matrix<unimath::C> c({
+		{1.0+1.0i, 2.0,      0.0},
+		{0.0,      3.0-1.0i, 1.0},
+		{1.0i,     0.0,      2.0}
+	});
+	auto e = unimath::eigen(c, true);
+	unimath::matrix<unimath::C> residual = c * (*e.vectors);
+	for(int i=0; i<3; i++)
+		for(int j=0; j<3; j++)
+			residual(i, j) -= e.values[j] * (*e.vectors)(i, j);
+	std::cout << residual << std::endl;
+}
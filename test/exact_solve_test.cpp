@@ -0,0 +1,63 @@
+#include "bareiss.hpp"
+#include "exact_solve.hpp"
+#include "fraction.hpp"
+#include "matrix.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+int main()
+{
+	unimath::matrix<unimath::fraction> a({
+		{1, 0, 9, 5, 7},
+		{0, 2, 1, 3, 1},
+		{1, 5, 8, 9, 0},
+		{7, 0, 1, 7, 4},
+		{9, 4, 3, 1, 6}
+	});
+	std::vector<unimath::fraction> b = {{1, 3}, 2, {-5, 7}, 0, 4};
+
+	auto x = unimath::exact_solve(a, b);
+	for(auto& v : x)
+		std::cout << v << " ";
+	std::cout << std::endl;
+
+	std::vector<std::vector<unimath::fraction>> column(b.size(), std::vector<unimath::fraction>(1));
+	for(int i=0; i<b.size(); i++)
+		column[i][0] = b[i];
+	std::cout << unimath::bareiss_inverse(a) * unimath::matrix<unimath::fraction>(column) << std::endl;
+
+	// Hilbert matrices, badly conditioned but still fine for refinement;
+	// from n = 11 on the residuals do not fit into 128 bit any more
+	for(int n : {6, 11})
+	{
+		std::vector<std::vector<unimath::fraction>> h(n, std::vector<unimath::fraction>(n));
+		std::vector<unimath::fraction> ones(n, 1);
+		for(int i=0; i<n; i++)
+			for(int j=0; j<n; j++)
+				h[i][j] = unimath::fraction(1L, (long)(i+j+1));
+		for(auto& v : unimath::exact_solve(unimath::matrix<unimath::fraction>(h), ones))
+			std::cout << v << " ";
+		std::cout << std::endl;
+	}
+
+	// the determinant of this matrix, i.e. the denominator of the solution, exceeds a long
+	unimath::matrix<unimath::fraction> c(6, 6);
+	long seed = 7;
+	for(int i=0; i<6; i++)
+	{
+		for(int j=0; j<6; j++)
+		{
+			seed = (seed*1103515245 + 12345) % 2147483648;
+			c(i, j) = (int)(seed % 20001) - 10000;
+		}
+	}
+	try
+	{
+		unimath::exact_solve(c, std::vector<unimath::fraction>(6, 1));
+	}
+	catch(const std::overflow_error& e)
+	{
+		std::cout << e.what() << std::endl;
+	}
+}
@@ -0,0 +1,44 @@
+#include "fixed_matrix.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <numbers>
+
+constexpr unimath::fixed_matrix<double, 2, 2> quarter_turn({
+	{0, -1},
+	{1,  0}
+});
+static_assert(quarter_turn*quarter_turn*quarter_turn*quarter_turn == unimath::fixed_matrix<double, 2, 2>::identity());
+static_assert(quarter_turn.inverse() == -quarter_turn);
+static_assert(quarter_turn.determinant() == 1);
+
+int main()
+{
+	using M3 = unimath::fixed_matrix<double, 3, 3>;
+
+	double error = 0;
+	for(int k=0; k<1000000; k++)
+	{
+		double phi = k * std::numbers::pi / 1000000;
+		M3 a({
+			{std::cos(phi), -std::sin(phi), 0},
+			{std::sin(phi),  std::cos(phi), 0},
+			{0,              0,             2}
+		});
+		auto x = a.solve({1, 2, 3});
+		auto b = a*x;
+		error = std::max(error, std::abs(b[0]-1) + std::abs(b[1]-2) + std::abs(b[2]-3));
+	}
+	std::cout << "max error of 10^6 solves: " << error << std::endl;
+
+	unimath::matrix<double> m({
+		{4, 1, 0, 0},
+		{1, 4, 1, 0},
+		{0, 1, 4, 1},
+		{0, 0, 1, 4}
+	});
+	unimath::fixed_matrix<double, 4, 4> f(m);
+	std::cout << "det = " << f.determinant() << std::endl;
+	std::cout << f.inverse()*f << std::endl;
+
+}
@@ -0,0 +1,159 @@
+#include "big_fraction.hpp"
+#include "fixed_matrix.hpp"
+#include "fraction.hpp"
+#include "matrix.hpp"
+#include "rationalize.hpp"
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+
+using unimath::fraction;
+
+/**
+ * Bernoulli numbers from sum_{j=0}^{m} binomial(m+1, j) B_j = 0, computed at compile time.
+ */
+template<int N>
+constexpr std::array<fraction, N> bernoulli()
+{
+	std::array<fraction, N> b{};
+	b[0] = 1;
+	for(int m=1; m<N; m++)
+	{
+		fraction sum = 0;
+		long binomial = 1;
+		for(int j=0; j<m; j++)
+		{
+			sum += fraction(binomial, 1L) * b[j];
+			binomial = binomial * (m+1-j) / (j+1);
+		}
+		b[m] = -sum / (m+1);
+	}
+	return b;
+}
+constexpr auto bernoulli_numbers = bernoulli<21>();
+static_assert(bernoulli_numbers[1] == fraction(-1, 2));
+static_assert(bernoulli_numbers[12] == fraction(-691, 2730));
+static_assert(bernoulli_numbers[20] == fraction(-174611, 330));
+
+// weights of the five point stencil for the second derivative: sum_j w_j x_j^i = d^2/dx^2 x^i at 0
+constexpr unimath::fixed_matrix<fraction, 5, 5> vandermonde({
+	{ 1,  1, 1, 1,  1},
+	{-2, -1, 0, 1,  2},
+	{ 4,  1, 0, 1,  4},
+	{-8, -1, 0, 1,  8},
+	{16,  1, 0, 1, 16}
+});
+constexpr auto stencil = vandermonde.solve({0, 0, 2, 0, 0});
+static_assert(stencil[0] == fraction(-1, 12) && stencil[1] == fraction(4, 3) && stencil[2] == fraction(-5, 2));
+
+int main()
+{
+	// fraction is exact as long as the reduced result fits into a long
+	fraction f(3037000499L, 3037000498L);
+	std::cout << "f*f = " << f*f << std::endl;
+	try
+	{
+		std::cout << f*f + fraction(1L, 3L) << std::endl;
+	}
+	catch(const std::overflow_error& e)
+	{
+		std::cout << e.what() << ", exact: " << unimath::big_fraction(f)*f + unimath::big_fraction(1, 3L) << std::endl;
+	}
+	fraction::overflow_policy(unimath::fraction_overflow::saturate);
+	std::cout << "saturated: " << f*f + fraction(1L, 3L) << ", " << fraction(std::numeric_limits<long>::max(), 1L) + 1 << std::endl;
+	fraction::overflow_policy(unimath::fraction_overflow::raise);
+
+	// binary gcd against std::gcd, also beyond 64 bit
+	unsigned long seed = 1;
+	auto next = [&seed]()
+	{
+		seed = seed*6364136223846793005ul + 1442695040888963407ul;
+		return seed;
+	};
+	bool same = unimath::fraction_gcd64(0, 12) == 12 && unimath::fraction_gcd64(12, 0) == 12 && unimath::fraction_gcd(0, 0) == 0;
+	for(int i=0; i<10000; i++)
+	{
+		unsigned long common = next() >> 40;
+		unsigned long a = (next() >> 40) * common, b = (next() >> 40) * common;
+		same = same && unimath::fraction_gcd64(a, b) == std::gcd(a, b);
+		unsigned __int128 wide = (unsigned __int128)(next() >> 20) << 20;
+		same = same && unimath::fraction_gcd(wide * a, wide * b) == wide * std::gcd(a, b);
+	}
+	std::cout << "binary gcd " << (same ? "agrees" : "disagrees") << " with std::gcd" << std::endl;
+
+	// fraction products are summed up without reducing every term
+	unimath::matrix<fraction> h(4, 4), hh(4, 4);
+	for(int i=0; i<4; i++)
+		for(int k=0; k<4; k++)
+			h(i, k) = fraction(1, i+k+1);
+	unimath::multiply_into(hh, h, h);
+	fraction eager = 0;
+	for(int k=0; k<4; k++)
+		eager += h(3, k) * h(k, 3);
+	std::cout << hh << std::endl << (hh(3, 3) == eager ? "same" : "different") << " as the eager sum" << std::endl;
+
+	// terms with coprime denominators overflow 128 bit, so the accumulator has to reduce in between
+	unimath::fraction_accumulator harmonic;
+	fraction sum = 0;
+	for(long k=1; k<=30; k++)
+	{
+		harmonic += fraction(1L, k);
+		sum += fraction(1L, k);
+	}
+	std::cout << "H(30) = " << harmonic.value() << (harmonic.value() == sum ? " (same as eager)" : " (differs from eager)") << std::endl;
+
+	// doubles to fractions: the shortest continued fraction that converts back
+	std::cout << "1.0/3 = " << fraction(1.0/3) << ", 0.1 = " << fraction(0.1) << ", -2.5 = " << fraction(-2.5)
+		<< ", exactly 0.1 = " << fraction::exact(0.1) << std::endl;
+	// magnitudes below 1/LONG_MAX have no such fraction
+	for(double tiny : {1e-300, -3e-25})
+	{
+		try
+		{
+			std::cout << fraction(tiny) << std::endl;
+		}
+		catch(const std::overflow_error& e)
+		{
+			std::cout << tiny << ": " << e.what() << std::endl;
+		}
+	}
+	fraction::overflow_policy(unimath::fraction_overflow::saturate);
+	std::cout << "saturated: " << fraction(1e-300) << ", " << fraction(3e-19) << ", " << fraction::exact(1e-300) << std::endl;
+	fraction::overflow_policy(unimath::fraction_overflow::raise);
+
+	// best approximations within a denominator bound, checked by brute force for small bounds
+	std::cout << "pi ~ " << fraction::approximate(std::numbers::pi, 1000) << ", " << fraction::approximate(std::numbers::pi, 30000) << std::endl;
+	bool within = true, best = true;
+	for(int i=0; i<2000; i++)
+	{
+		double x = (double)(next() >> 11) / (1ul << 53) * 20 - 10;
+		long bound = 1 + (next() >> 59);
+		fraction a = fraction::approximate(x, bound);
+		within = within && a.denominator() <= bound;
+		double error = std::abs(x - (double)a);
+		for(long q=1; q<=bound; q++)
+		{
+			double p = std::round(x*q);
+			best = best && error <= std::abs(x - p/q) * (1 + 1e-12);
+		}
+	}
+	std::cout << "approximate " << (within ? "keeps" : "exceeds") << " the denominator bound and " << (best ? "is" : "is not") << " the best approximation" << std::endl;
+
+	// measured values to fractions
+	unimath::matrix<double> measured({
+		{0.1, 1.0/3, -2.5},
+		{3.141592653589793, 1e-5, 0.7071067811865476}
+	});
+	std::cout << unimath::rationalize(measured) << std::endl;
+	std::cout << unimath::rationalize(measured, 1000) << std::endl;
+
+	std::cout << "B_20 = " << bernoulli_numbers[20] << ", stencil:";
+	for(auto& w : stencil)
+		std::cout << " " << w;
+	std::cout << std::endl;
+}
@@ -0,0 +1,49 @@
+#include "krylov.hpp"
+#include "sparse_matrix.hpp"
+
+#include <iostream>
+
+int main()
+{
+	// 2D Poisson problem on a 100x100 grid
+	const int m = 100;
+	const int n = m*m;
+
+	std::vector<unimath::sparse_matrix<double>::triplet> entries;
+	for(int i=0; i<m; i++)
+	{
+		for(int j=0; j<m; j++)
+		{
+			int k = i*m+j;
+			entries.push_back({k, k, 4.0});
+			if(i > 0)   entries.push_back({k, k-m, -1.0});
+			if(i < m-1) entries.push_back({k, k+m, -1.0});
+			if(j > 0)   entries.push_back({k, k-1, -1.0});
+			if(j < m-1) entries.push_back({k, k+1, -1.0});
+		}
+	}
+	unimath::sparse_matrix<double> a(n, n, entries);
+	std::vector<double> b(n, 1.0);
+
+	auto cg = unimath::conjugate_gradient(unimath::as_operator(a), b);
+	std::cout << "CG:             " << cg.iterations << " iterations, residual " << cg.residuals.back() << std::endl;
+
+	auto pcg = unimath::conjugate_gradient(unimath::as_operator(a), b, unimath::ilu0_preconditioner<double>(a));
+	std::cout << "CG + ILU(0):    " << pcg.iterations << " iterations, residual " << pcg.residuals.back() << std::endl;
+
+	auto gm = unimath::gmres(unimath::as_operator(a), b, unimath::jacobi_preconditioner<double>(a), 1e-10, 50, 5000);
+	std::cout << "GMRES + Jacobi: " << gm.iterations << " iterations, residual " << gm.residuals.back() << std::endl;
+
+	auto pgm = unimath::gmres(unimath::as_operator(a), b, unimath::ilu0_preconditioner<double>(a));
+	std::cout << "GMRES + ILU(0): " << pgm.iterations << " iterations, residual " << pgm.residuals.back() << std::endl;
+
+	// matrix-free operator: y = x + shift of x
+	unimath::linear_operator<double> shift = [](const std::vector<double>& x, std::vector<double>& y){
+		for(int i=0; i<x.size(); i++)
+			y[i] = 2*x[i] - (i > 0 ? x[i-1] : 0);
+	};
+	auto free = unimath::gmres<double>(shift, {1, 1, 1, 1});
+	for(auto v : free.x)
+		std::cout << v << " ";
+	std::cout << std::endl;
+}
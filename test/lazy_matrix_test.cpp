@@ -0,0 +1,73 @@
+#include "fraction.hpp"
+#include "matrix.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+using unimath::fraction;
+using unimath::matrix;
+
+template<typename K>
+bool same(const matrix<K>& a, const matrix<K>& b)
+{
+	if(a.rows() != b.rows() || a.columns() != b.columns())
+		return false;
+	for(int i=0; i<a.rows(); i++)
+		for(int j=0; j<a.columns(); j++)
+			if(!(a(i, j) == b(i, j)))
+				return false;
+	return true;
+}
+
+matrix<fraction> filled(int rows, int columns, int seed)
+{
+	matrix<fraction> m(rows, columns);
+	for(int i=0; i<rows; i++)
+		for(int j=0; j<columns; j++)
+			m(i, j) = fraction((i*7 + j*3 + seed) % 11 - 5, (i + j + seed) % 4 + 1);
+	return m;
+}
+
+matrix<fraction> eager_product(const matrix<fraction>& a, const matrix<fraction>& b)
+{
+	matrix<fraction> result(a.rows(), b.columns());
+	for(int i=0; i<a.rows(); i++)
+		for(int j=0; j<b.columns(); j++)
+			for(int k=0; k<a.columns(); k++)
+				result(i, j) += a(i, k) * b(k, j);
+	return result;
+}
+
+int main()
+{
+	// 10x100 * 100x5 * 5x50: (AB)C needs 5000 + 2500 multiplications, A(BC) 25000 + 50000
+	matrix<double> a(10, 100), b(100, 5), c(5, 50);
+	auto chain = a*b*c;
+	std::cout << "cost " << chain.cost() << ", " << chain.rows() << "x" << chain.columns() << std::endl;
+
+	// lazy sums and chained products against entry by entry evaluation
+	matrix<fraction> x = filled(4, 3, 1), y = filled(4, 3, 2), z = filled(4, 3, 3);
+	matrix<fraction> eager(4, 3);
+	for(int i=0; i<4; i++)
+		for(int j=0; j<3; j++)
+			eager(i, j) = x(i, j) + y(i, j) - z(i, j);
+	std::cout << "x+y-z " << (same(matrix<fraction>(x+y-z), eager) ? "equals" : "differs from") << " the eager sum" << std::endl;
+	matrix<fraction> p = filled(3, 5, 4), q = filled(5, 2, 5), r = filled(2, 6, 6);
+	std::cout << "x*p*q*r " << (same(matrix<fraction>(x*p*q*r), eager_product(eager_product(eager_product(x, p), q), r)) ? "equals" : "differs from")
+		<< " the eager product" << std::endl;
+
+	// temporaries are owned by the expression, so it can be kept and evaluated later
+	auto kept = filled(4, 3, 1) + y;
+	auto negated = -(filled(4, 3, 3) - x);
+	auto product = filled(4, 3, 1) * filled(3, 5, 4);
+	std::cout << "kept expressions: " << same(matrix<fraction>(kept), matrix<fraction>(x+y)) << same(matrix<fraction>(negated), matrix<fraction>(x-z))
+		<< same(matrix<fraction>(product), eager_product(x, p)) << std::endl;
+
+	// floating point products keep 0*NaN = NaN and 0*Inf = NaN
+	matrix<double> zero(1, 2), special(2, 1);
+	special(0, 0) = std::numeric_limits<double>::quiet_NaN();
+	special(1, 0) = std::numeric_limits<double>::infinity();
+	matrix<double> nan = zero*special;
+	std::cout << "0*(NaN, Inf) = " << (std::isnan(nan(0, 0)) ? "NaN" : "a number") << std::endl;
+}
@@ -0,0 +1,43 @@
+#include "qr.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+int main()
+{
+	// fit a cubic to 10^6 noisy samples, generated block by block
+	const int samples = 1000000;
+	const int block = 4096;
+
+	std::default_random_engine generator;
+	std::normal_distribution<double> noise(0, 1e-3);
+
+	unimath::streaming_qr<double> qr(4);
+	for(int first=0; first<samples; first+=block)
+	{
+		int count = std::min(block, samples-first);
+		std::vector<std::vector<double>> rows(count, std::vector<double>(4));
+		std::vector<double> b(count);
+		for(int i=0; i<count; i++)
+		{
+			double t = double(first+i)/samples;
+			for(int j=0; j<4; j++)
+				rows[i][j] = std::pow(t, j);
+			b[i] = 1 - 2*t + 3*t*t - 4*t*t*t + noise(generator);
+		}
+		qr.add_rows(unimath::matrix<double>(rows), b);
+	}
+
+	auto x = qr.solve();
+	std::cout << "p(t) = " << x[0] << " + " << x[1] << "t + " << x[2] << "t^2 + " << x[3] << "t^3" << std::endl;
+	std::cout << "residual = " << qr.residual_norm() << std::endl;
+
+	unimath::matrix<double> a({
+		{1, 0},
+		{0, 1},
+		{1, 1}
+	});
+	auto y = unimath::least_squares(a, {1, 1, 0});
+	std::cout << "x = (" << y[0] << ", " << y[1] << ")" << std::endl;
+}
@@ -0,0 +1,98 @@
+#include "fraction.hpp"
+#include "mapped_matrix.hpp"
+#include "matrix.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <unistd.h>
+
+/**
+ * A file name in the temporary directory that is unique to this run, removed at the end of the scope.
+ */
+struct temporary_file
+{
+	std::filesystem::path path;
+
+	explicit temporary_file(const std::string& name) : path(std::filesystem::temp_directory_path() /
+		("unimath_" + name + "_" + std::to_string(::getpid()) + "_" + std::to_string(std::random_device()()) + ".mat"))
+	{
+	}
+
+	~temporary_file()
+	{
+		std::error_code error;
+		std::filesystem::remove(path, error);
+	}
+
+	std::string name() const { return path.string(); }
+};
+
+int main()
+{
+	// declared first, so that the files are removed after the matrices are unmapped
+	temporary_file file_a("a"), file_b("b"), file_c("c"), file_sum("sum"), file_f("f"), file_g("g");
+
+	int n = 150;
+	unsigned long seed = 1;
+	auto next = [&seed](){
+		seed = seed*6364136223846793005ul + 1442695040888963407ul;
+		return (long)(seed >> 33) % 19 - 9;
+	};
+
+	unimath::matrix<double> a(n, n+7), b(n+7, n-20);
+	for(int i=0; i<a.rows(); i++)
+		for(int j=0; j<a.columns(); j++)
+			a(i, j) = next();
+	for(int i=0; i<b.rows(); i++)
+		for(int j=0; j<b.columns(); j++)
+			b(i, j) = next();
+
+	{
+		unimath::mapped_matrix<double> ma(file_a.name(), a);
+		unimath::mapped_matrix<double> mb(file_b.name(), b);
+		unimath::mapped_matrix<double> mc(file_c.name(), a.rows(), b.columns());
+		unimath::multiply_into(mc, ma, mb);
+	}
+
+	// reopen the product from disk
+	unimath::mapped_matrix<double> mc(file_c.name());
+	unimath::matrix<double> c = a*b;
+	double difference = 0;
+	for(int i=0; i<c.rows(); i++)
+		for(int j=0; j<c.columns(); j++)
+			difference = std::max(difference, std::abs(c(i, j) - mc(i, j)));
+	std::cout << "product " << mc.rows() << "x" << mc.columns() << ", max difference " << difference << std::endl;
+
+	unimath::mapped_matrix<double> sum(file_sum.name(), n, n+7);
+	unimath::mapped_matrix<double> ma(file_a.name());
+	binary_transform(ma, ma, [](double x, double y){ return x+y; }, sum);
+	std::cout << "sum ok: " << std::boolalpha << (unimath::matrix<double>(sum)(17, 99) == 2*a(17, 99)) << std::endl;
+
+	// elimination does the same operations as in memory, so the result is identical
+	int m = 140;
+	unimath::matrix<double> f(m, m+3);
+	for(int i=0; i<m; i++)
+		for(int j=0; j<m+3; j++)
+			f(i, j) = i%5 == 4 ? f(i-1, j) + f(i-2, j) : next();
+	unimath::mapped_matrix<double> mf(file_f.name(), f);
+	auto pivots = mf.nzsf();
+	auto expected = f.nzsf();
+	bool equal = pivots == expected;
+	for(int i=0; i<m && equal; i++)
+		for(int j=0; j<m+3 && equal; j++)
+			equal = mf(i, j) == f(i, j);
+	std::cout << "identical to matrix::nzsf: " << equal << std::endl;
+
+	unimath::matrix<unimath::fraction> g({
+		{1, {1, 2}, 3},
+		{{2, 3}, 0, 1},
+		{{5, 3}, {1, 2}, 4}
+	});
+	unimath::mapped_matrix<unimath::fraction> mg(file_g.name(), g);
+	mg.nzsf();
+	std::cout << unimath::matrix<unimath::fraction>(mg) << std::endl;
+}
@@ -0,0 +1,61 @@
+#include "fixed_matrix.hpp"
+#include "fraction.hpp"
+#include "matrix.hpp"
+#include "matrix_functions.hpp"
+
+#include <cmath>
+#include <iostream>
+
+int main()
+{
+	unimath::matrix<long> fib({
+		{1, 1},
+		{1, 0}
+	});
+	std::cout << unimath::pow(fib, 90) << std::endl;
+	std::cout << "fib(90) = " << unimath::linear_recurrence<long>({1, 1}, {0, 1}, 90) << std::endl;
+
+	unimath::matrix<unimath::fraction> m({
+		{{1, 2}, 1},
+		{0, {1, 3}}
+	});
+	std::cout << unimath::pow(m, 5) << std::endl;
+
+	// rotation generator, e^(t*J) is the rotation by t
+	unimath::matrix<double> j({
+		{0, -1},
+		{1, 0}
+	});
+	std::cout << unimath::expm(unimath::matrix<double>(j)) << std::endl;
+	std::cout << std::cos(1.0) << " " << std::sin(1.0) << std::endl << std::endl;
+
+	// large norm, needs scaling and squaring
+	unimath::matrix<double> a({
+		{-49, 24},
+		{-64, 31}
+	});
+	std::cout << unimath::expm(a) << std::endl;
+
+	constexpr unimath::fixed_matrix<double, 2, 2> f({
+		{0, 1},
+		{-2, -3}
+	});
+	std::cout << unimath::expm(f) << std::endl;
+	std::cout << unimath::pow(f, 3) << std::endl;
+
+	// explicit Euler steps x += h*A*x without allocations in the loop
+	unimath::matrix<double> x(2, 1), ax(2, 1);
+	x(0, 0) = 1;
+	for(int k=0; k<1000; k++)
+	{
+		unimath::multiply_into(ax, j, x);
+		x.axpy(1e-3, ax);
+	}
+	std::cout << x << std::endl;
+
+	unimath::matrix<long> g = fib;
+	g *= fib;
+	g += fib - unimath::matrix<long>::identity(2);
+	g *= 2L;
+	std::cout << g << std::endl;
+}
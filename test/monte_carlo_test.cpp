@@ -0,0 +1,76 @@
+#include "monte_carlo.hpp"
+
+#include <cmath>
+#include <iostream>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+
+int main()
+{
+	// divider of two 1 kOhm resistors with 5%: V(2) = R2/(R1+R2)
+	unimath::circuit divider;
+	divider.voltage_source(1, 0, 1);
+	int r1 = divider.resistor(1, 2, 1e3);
+	int r2 = divider.resistor(2, 0, 1e3);
+
+	unimath::monte_carlo analysis(divider);
+	analysis.tolerance(r1, 0.05);
+	analysis.tolerance(r2, 0.05);
+	auto result = analysis.run(0, {2}, 100000, 0.05, 20);
+	auto& v = result[0];
+	std::cout << "V(2): nominal " << v.nominal.real() << ", mean " << v.magnitude.mean() << ", deviation " << v.magnitude.deviation()
+		<< ", range [" << v.magnitude.min() << ", " << v.magnitude.max() << "] of " << v.magnitude.count() << " samples" << std::endl;
+	for(int i=0; i<v.deviation.bins(); i++)
+	{
+		std::cout.width(7);
+		std::cout << v.deviation.bin(i)*100 << "% " << std::string(v.deviation.counts()[i]/500, '#') << std::endl;
+	}
+
+	// the same seed gives the same statistics
+	auto again = analysis.run(0, {2}, 100000, 0.05, 20);
+	std::cout << "reproducible: " << (again[0].magnitude.mean() == v.magnitude.mean() && again[0].deviation.counts() == v.deviation.counts()) << std::endl;
+
+	// RC low pass at its nominal cutoff with a 10% (3 sigma) capacitor
+	unimath::circuit rc;
+	rc.voltage_source(1, 0, 1);
+	rc.resistor(1, 2, 1000);
+	int c = rc.capacitor(2, 0, 1e-6);
+	unimath::monte_carlo spread(rc);
+	spread.tolerance(c, 0.1, unimath::tolerance_distribution::gaussian);
+	auto cutoff = spread.run(1/(2*std::numbers::pi*1000*1e-6), {2}, 50000)[0];
+	std::cout << "|V(2)| = " << cutoff.magnitude.mean() << " +- " << cutoff.magnitude.deviation()
+		<< ", phase = " << cutoff.phase.mean()*180/std::numbers::pi << " +- " << cutoff.phase.deviation()*180/std::numbers::pi << " degrees, "
+		<< cutoff.deviation.below() + cutoff.deviation.above() << " outside of 25%" << std::endl;
+
+	// a 150% gaussian tolerance would make about 2% of the capacitances negative (with a
+	// positive phase), these are drawn again
+	spread.tolerance(c, 1.5, unimath::tolerance_distribution::gaussian);
+	auto wide = spread.run(1/(2*std::numbers::pi*1000*1e-6), {2}, 10000)[0];
+	std::cout << "wide tolerance: phase in [" << wide.phase.min()*180/std::numbers::pi << ", " << wide.phase.max()*180/std::numbers::pi << "] degrees" << std::endl;
+	try
+	{
+		spread.tolerance(c, 1);
+	}
+	catch(const std::domain_error& e)
+	{
+		std::cout << e.what() << std::endl;
+	}
+
+	// at DC the inductor is a short and the capacitor between 2 and 3 is open,
+	// although both leave no entries in the MNA matrix there
+	unimath::circuit rl;
+	rl.voltage_source(1, 0, 1);
+	int r = rl.resistor(1, 2, 1000);
+	int l = rl.inductor(2, 0, 1e-3);
+	rl.resistor(1, 3, 1000);
+	int c23 = rl.capacitor(2, 3, 1e-6);
+	rl.resistor(3, 0, 1000);
+	unimath::monte_carlo dc(rl);
+	dc.tolerance(r, 0.05);
+	dc.tolerance(l, 0.2);
+	dc.tolerance(c23, 0.2);
+	auto shorted = dc.run(0, {2, 3}, 10000);
+	std::cout << "DC: V(2) = " << shorted[0].magnitude.mean() << " in [" << shorted[0].magnitude.min() << ", " << shorted[0].magnitude.max()
+		<< "], V(3) = " << shorted[1].magnitude.mean() << " +- " << shorted[1].magnitude.deviation() << std::endl;
+}
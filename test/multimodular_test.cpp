@@ -0,0 +1,63 @@
+#include "bareiss.hpp"
+#include "matrix.hpp"
+#include "multimodular.hpp"
+
+#include <iostream>
+#include <vector>
+
+/**
+ * Pseudo random n x n matrix with entries in [-bound, bound].
+ */
+unimath::matrix<long> random_matrix(int n, long bound, unsigned long seed)
+{
+	std::vector<std::vector<long>> entries(n, std::vector<long>(n));
+	for(auto& row : entries)
+		for(auto& e : row)
+		{
+			seed = seed*6364136223846793005ul + 1442695040888963407ul;
+			e = (long)(seed >> 33) % (2*bound+1) - bound;
+		}
+	return unimath::matrix<long>(entries);
+}
+
+int main()
+{
+	unimath::matrix<long> m({
+		{1, 0, 9, 5, 7},
+		{0, 2, 1, 3, 1},
+		{1, 5, 8, 9, 0},
+		{7, 0, 1, 7, 4},
+		{9, 4, 3, 1, 6}
+	});
+	std::cout << "det = " << unimath::multimodular_det(m) << " (bareiss: " << unimath::bareiss_det(m) << ")" << std::endl;
+
+	// the determinant does not fit into long anymore
+	std::cout << "det = " << unimath::multimodular_det(random_matrix(8, 10000, 1)) << std::endl;
+	// nor into 128 bit
+	std::cout << "det = " << unimath::multimodular_det(random_matrix(12, 1000, 2)) << std::endl;
+	std::cout << "det = " << unimath::multimodular_det(random_matrix(64, 1000000, 3)) << std::endl;
+
+	unimath::matrix<long> singular({
+		{1, 2, 3, 4},
+		{2, 4, 6, 8},
+		{1, 0, 1, 0},
+		{3, 2, 5, 4}
+	});
+	std::cout << "det = " << unimath::multimodular_det(singular) << std::endl;
+	std::cout << "rank = " << unimath::multimodular_rank(singular) << std::endl;
+	std::cout << "nullity = " << unimath::multimodular_nullity(singular) << std::endl;
+
+	// every one of the 17 largest primes below 2^62 divides one diagonal entry, so the
+	// rank modulo each of them is 16; the Hadamard bound of about 2^1054 asks for one more
+	std::vector<long> primes = {
+		0x3fffffffffffffc7, 0x3fffffffffffffa9, 0x3fffffffffffff8b, 0x3fffffffffffff71,
+		0x3fffffffffffff67, 0x3fffffffffffff59, 0x3fffffffffffff55, 0x3fffffffffffff3d,
+		0x3fffffffffffff35, 0x3ffffffffffffeef, 0x3ffffffffffffee1, 0x3ffffffffffffec3,
+		0x3ffffffffffffe45, 0x3ffffffffffffe1d, 0x3ffffffffffffe11, 0x3ffffffffffffdc1,
+		0x3ffffffffffffdbb
+	};
+	unimath::matrix<long> diagonal(17, 17);
+	for(int i=0; i<17; i++)
+		diagonal(i, i) = primes[i];
+	std::cout << "rank = " << unimath::multimodular_rank(diagonal) << ", nullity = " << unimath::multimodular_nullity(diagonal) << std::endl;
+}
@@ -1,9 +1,12 @@
 #include "nodal_analysis.hpp"
 
 #include <array>
+#include <cmath>
 #include <complex>
+#include <numbers>
 #include <optional>
 #include <iostream>
+#include <vector>
 
 int main()
 {
@@ -19,11 +22,123 @@ int main()
 				   GND
 	*/
 
+	// current injected into the nodes 1 (left), 2 (middle) and 3 (right)
 	std::array<std::optional<std::complex<double>>, 3> sources = {
 		2,
 		{},
 		1.5
 	};
 
+	unimath::circuit network;
+	network.resistor(1, 0, 1);
+	network.resistor(3, 0, 2);
+	network.resistor(1, 2, 3);
+	network.resistor(2, 3, 4);
+	network.resistor(2, 0, 5);
+	int r6 = network.resistor(1, 3, 6);
+	for(int i=0; i<sources.size(); i++)
+		if(sources[i])
+			network.current_source(0, i+1, *sources[i]);
+
+	auto dc = network.solve(0);
+	for(int i=1; i<=3; i++)
+		std::cout << "V" << i << " = " << dc.voltage(i).real() << " V" << std::endl;
+	std::cout << "I(R6) = " << dc.current(r6).real() << " A" << std::endl;
+
+	// RC low pass at its cutoff frequency: |H| = 1/sqrt(2), phase -45 degrees
+	unimath::circuit rc;
+	rc.voltage_source(1, 0, 1);
+	rc.resistor(1, 2, 1000);
+	rc.capacitor(2, 0, 1e-6);
+	auto cutoff = rc.solve(1/(2*std::numbers::pi*1000*1e-6));
+	std::cout << "|H| = " << std::abs(cutoff.voltage(2)) << ", phase = " << std::arg(cutoff.voltage(2))*180/std::numbers::pi << " degrees" << std::endl;
+
+	// series resonance: the inductor is a short at DC and cancels the capacitor at f0
+	unimath::circuit rlc;
+	int source = rlc.voltage_source(1, 0, 1);
+	rlc.resistor(1, 2, 10);
+	rlc.inductor(2, 3, 1e-3);
+	rlc.capacitor(3, 0, 1e-6);
+	double f0 = 1/(2*std::numbers::pi*std::sqrt(1e-3*1e-6));
+	std::cout << "I(f0) = " << std::abs(rlc.solve(f0).current(source)) << " A, V3(DC) = " << rlc.solve(0).voltage(3).real() << " V" << std::endl;
+
+	// inverting amplifier with an op amp modelled as vcvs of high gain
+	unimath::circuit amplifier;
+	amplifier.voltage_source(1, 0, 0.1);
+	amplifier.resistor(1, 2, 1e3);
+	amplifier.resistor(2, 3, 10e3);
+	amplifier.vcvs(3, 0, 0, 2, 1e6);
+	std::cout << "V(out) = " << amplifier.solve(0).voltage(3).real() << " V" << std::endl;
+
+	// current mirror with a cccs sensing a 0 V source, driving a ccvs
+	unimath::circuit controlled;
+	controlled.current_source(0, 1, 1e-3);
+	int sense = controlled.voltage_source(1, 2, 0);
+	controlled.resistor(2, 0, 100);
+	controlled.cccs(0, 3, sense, 2);
+	controlled.resistor(3, 0, 1e3);
+	controlled.ccvs(4, 0, sense, 500);
+	controlled.resistor(4, 0, 1);
+	controlled.vccs(0, 5, 3, 0, 1e-3);
+	controlled.resistor(5, 0, 1e3);
+	auto c = controlled.solve(0);
+	std::cout << "V3 = " << c.voltage(3).real() << " V, V4 = " << c.voltage(4).real() << " V, V5 = " << c.voltage(5).real() << " V" << std::endl;
+
+	// RC ladder of 200 sections swept over 10^4 frequencies from 1 Hz to 1 MHz
+	unimath::circuit ladder;
+	ladder.voltage_source(1, 0, 1);
+	for(int k=1; k<=200; k++)
+	{
+		ladder.resistor(k, k+1, 10);
+		ladder.capacitor(k+1, 0, 1e-9);
+	}
+	std::vector<double> frequencies(10000);
+	for(int i=0; i<frequencies.size(); i++)
+		frequencies[i] = std::pow(10.0, 6.0*i/(frequencies.size()-1));
+
+	unimath::ac_sweep sweep(ladder);
+	std::vector<int> probes = {2, 101, 201};
+	std::vector<std::complex<double>> columns(probes.size()*frequencies.size());
+	sweep.run(frequencies, probes, columns.data());
+
+	double deviation = 0;
+	for(int i : {0, 4321, 9999})
+	{
+		auto reference = ladder.solve(frequencies[i]);
+		for(int k=0; k<probes.size(); k++)
+			deviation = std::max(deviation, std::abs(columns[k*frequencies.size()+i] - reference.voltage(probes[k])));
+	}
+	std::vector<double> magnitude(frequencies.size());
+	sweep.run(frequencies, [&](int i, const unimath::ac_solution& solution)
+	{
+		magnitude[i] = std::abs(solution.voltage(201));
+	});
+	for(int i=0; i<frequencies.size(); i++)
+		deviation = std::max(deviation, std::abs(magnitude[i] - std::abs(columns[2*frequencies.size()+i])));
+	std::cout << "sweep deviation = " << deviation << ", |V201| at 1 kHz = " << magnitude[5000] << std::endl;
+
+	// transfer function of the series RLC to the capacitor: 1/(LC s^2 + RC s + 1)
+	auto [numerator, denominator] = rlc.transfer_function(3);
+	std::cout << "H(s) = (" << numerator << ") / (" << denominator << ")" << std::endl;
+	std::cout << "poles:";
+	for(auto pole : denominator.roots())
+		std::cout << " " << pole;
+	std::cout << std::endl;
+	auto [polynomial, parts] = unimath::complex_pfd(numerator, denominator);
+	for(auto& part : parts)
+		std::cout << part << std::endl;
+
+	// a three section RC ladder, compared with solving at 1 kHz
+	unimath::circuit filter;
+	filter.voltage_source(1, 0, 1);
+	for(int k=1; k<=3; k++)
+	{
+		filter.resistor(k, k+1, 1e3);
+		filter.capacitor(k+1, 0, 1e-7);
+	}
+	auto [n3, d3] = filter.transfer_function(4);
+	std::complex<double> s(0, 2*std::numbers::pi*1e3);
+	std::cout << "deg D = " << d3.deg() << ", |N/D - V4| at 1 kHz = " << std::abs(n3(s)/d3(s) - filter.solve(1e3).voltage(4)) << std::endl;
+
 	return 0;
-}
\ No newline at end of file
+}
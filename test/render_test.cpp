@@ -0,0 +1,23 @@
+#include "fraction.hpp"
+#include "latex.hpp"
+#include "polynom.hpp"
+
+#include <complex>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+int main()
+{
+	// the whole value is one field, like the standard operator<< of std::complex pads it
+	std::complex<double> c(1.5, -2);
+	std::ostringstream standard;
+	standard << '(' << c.real() << ',' << c.imag() << ')';
+	std::cout << "|" << std::setw(12) << c << "|" << std::setw(12) << standard.str() << "|" << std::endl;
+	std::cout << "|" << std::left << std::setw(12) << c << "|" << std::right << std::setfill('.') << std::setw(12) << c << "|" << std::setfill(' ') << std::endl;
+
+	// the width only applies to the next field
+	std::cout << "|" << std::setw(8) << unimath::fraction(-3, 4) << "|" << unimath::fraction(5, 2) << "|" << std::endl;
+	std::cout << "|" << std::setw(32) << unimath::polynom({1, -2, 3}) << "|" << std::endl;
+	std::cout << "|" << std::setw(3) << unimath::fraction(123456, 7) << "|" << 42 << "|" << std::endl;
+}
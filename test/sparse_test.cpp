@@ -0,0 +1,42 @@
+#include "sparse_matrix.hpp"
+
+#include <cmath>
+#include <iostream>
+
+int main()
+{
+	// ladder network: every node is connected to its neighbours and to ground
+	const int n = 100000;
+
+	std::vector<unimath::sparse_matrix<double>::triplet> entries;
+	for(int i=0; i<n; i++)
+	{
+		entries.push_back({i, i, 2.5});
+		if(i > 0) entries.push_back({i, i-1, -1.0});
+		if(i < n-1) entries.push_back({i, i+1, -1.0});
+	}
+	unimath::sparse_matrix<double> a(n, n, entries);
+
+	unimath::sparse_lu<double> lu(a);
+	std::cout << "nonzeros: A = " << a.nonzeros() << ", L+U = " << lu.nonzeros() << std::endl;
+
+	std::vector<double> b(n);
+	b[0] = 1.0;
+	std::vector<double> x = lu.solve(b);
+
+	std::vector<double> r = a*x;
+	double residual = 0;
+	for(int i=0; i<n; i++)
+		residual = std::max(residual, std::abs(r[i]-b[i]));
+	std::cout << "x[0] = " << x[0] << ", x[1] = " << x[1] << ", residual = " << residual << std::endl;
+
+	unimath::matrix<double> m({
+		{4, 1, 0},
+		{1, 4, 1},
+		{0, 1, 4}
+	});
+	unimath::sparse_matrix<double> s(m);
+	unimath::sparse_lu<double> small(s);
+	std::cout << "det = " << small.determinant() << std::endl;
+	std::cout << s.transpose().dense() << std::endl;
+}
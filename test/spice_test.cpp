@@ -0,0 +1,92 @@
+#include "spice.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+/**
+ * Removes the file when it goes out of scope, also when an exception passes.
+ */
+struct temporary_file
+{
+	std::filesystem::path path;
+
+	~temporary_file()
+	{
+		std::error_code error;
+		std::filesystem::remove(path, error);
+	}
+};
+
+int main()
+{
+	auto filter = unimath::parse_spice(
+		"RC low pass with buffer\n"
+		"* the source is given with DC and AC values\n"
+		"Vin in 0 DC 5 AC 1 0\n"
+		"R1 in mid 1k ; 1 kOhm\n"
+		"C1 mid GND 159.15494nF\n"
+		"E1 out 0 mid 0 2\n"
+		"Rload out 0\n"
+		"+ 10meg\n"
+		"* F senses the current of Vsense, which is only defined below\n"
+		"F1 0 probe Vsense 3\n"
+		"Rprobe probe 0 100\n"
+		"H1 copy 0 Vsense 50\n"
+		"Vsense out sink 0\n"
+		"Rsink sink 0 1k\n"
+		".ac dec 10 1 1meg\n"
+		".end\n"
+		"R9 this is not read\n");
+
+	std::cout << filter.title() << ": " << filter.nodes() << " nodes, " << filter.network().elements().size() << " elements" << std::endl;
+	auto cutoff = filter.network().solve(1e3);
+	std::cout << "|V(mid)| = " << std::abs(cutoff.voltage(filter.node("mid"))) << ", phase = " << std::arg(cutoff.voltage(filter.node("mid")))*180/std::numbers::pi << " degrees" << std::endl;
+	std::cout << "|I(Vsense)| = " << std::abs(cutoff.current(filter.element("Vsense"))) << " A, |V(probe)| = " << std::abs(cutoff.voltage(filter.node("probe")))
+		<< " V, |V(copy)| = " << std::abs(cutoff.voltage(filter.node("copy"))) << " V" << std::endl;
+
+	// a long RC ladder written to a file of its own and mapped back in
+	try
+	{
+		temporary_file file(std::filesystem::temp_directory_path() /
+			("unimath_ladder_" + std::to_string(::getpid()) + "_" + std::to_string(std::random_device()()) + ".cir"));
+		{
+			std::ofstream out(file.path);
+			out << "RC ladder\nV1 n0 0 AC 1\n";
+			for(int k=0; k<100000; k++)
+			{
+				out << "R" << k << " n" << k << " n" << k+1 << " 1\n";
+				out << "C" << k << " n" << k+1 << " 0 1u\n";
+			}
+			out << ".end\n";
+		}
+		auto ladder = unimath::read_spice(file.path);
+		auto dc = ladder.network().solve(0);
+		std::cout << ladder.title() << ": " << ladder.nodes() << " nodes, V(n100000) = " << dc.voltage(ladder.node("n100000")).real() << " V" << std::endl;
+	}
+	catch(const std::exception& e)
+	{
+		std::cout << "ladder: " << e.what() << std::endl;
+		return 1;
+	}
+
+	for(auto text : {"title\nR1 1 0\n", "title\nR1 1 0 ohm\n", "title\nQ1 1 2 3 model\n", "title\nF1 1 0 Vnone 2\n",
+		"title\nV1 1 0 1\nR1 1 0 0\n"})
+	{
+		try
+		{
+			unimath::parse_spice(text);
+		}
+		catch(const std::runtime_error& e)
+		{
+			std::cout << e.what() << std::endl;
+		}
+	}
+}
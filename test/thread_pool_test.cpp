@@ -0,0 +1,130 @@
+#include "fraction.hpp"
+#include "matrix.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+template<typename K>
+bool same(const unimath::matrix<K>& a, const unimath::matrix<K>& b)
+{
+	if(a.rows() != b.rows() || a.columns() != b.columns())
+		return false;
+	for(int i=0; i<a.rows(); i++)
+		for(int j=0; j<a.columns(); j++)
+			if(!(a(i, j) == b(i, j)))
+				return false;
+	return true;
+}
+
+/**
+ * Reduces and inverts m once serially and once with every step split across
+ * thread_pool::shared(), and compares the results exactly. Every row is
+ * updated by the same operations either way, so nothing may differ, not even
+ * the rounding of doubles.
+ */
+template<typename K>
+bool same_as_serial(const unimath::matrix<K>& m)
+{
+	long threshold = unimath::matrix<K>::parallel_threshold();
+	unimath::matrix<K> serial = m, parallel = m;
+
+	unimath::matrix<K>::parallel_threshold(std::numeric_limits<long>::max());
+	auto serial_pivots = serial.nzsf();
+	auto serial_inverse = unimath::matrix<K>(m).inverse();
+	unimath::matrix<K>::parallel_threshold(0);
+	auto parallel_pivots = parallel.nzsf();
+	auto parallel_inverse = unimath::matrix<K>(m).inverse();
+	unimath::matrix<K>::parallel_threshold(threshold);
+
+	return serial_pivots == parallel_pivots && same(serial, parallel) && same(serial_inverse, parallel_inverse);
+}
+
+int main()
+{
+	unsigned long seed = 1;
+	auto next = [&seed]()
+	{
+		seed = seed*6364136223846793005ul + 1442695040888963407ul;
+		return (long)(seed >> 33) % 19 - 9;
+	};
+
+	unimath::matrix<double> d(120, 120);
+	for(int i=0; i<d.rows(); i++)
+		for(int j=0; j<d.columns(); j++)
+			d(i, j) = next();
+	unimath::matrix<unimath::fraction> f(6, 6);
+	for(int i=0; i<f.rows(); i++)
+		for(int j=0; j<f.columns(); j++)
+			f(i, j) = unimath::fraction(next() % 4, 1l + (i+j) % 2);
+	std::cout << "parallel elimination identical to serial: " << same_as_serial(d) << same_as_serial(f) << std::endl;
+
+	// a pool of its own, so that the loops are split even on a single core
+	unimath::thread_pool pool(4);
+	std::vector<long> squares(1000);
+	pool.parallel_for(0, squares.size(), [&](int first, int last)
+	{
+		for(int i=first; i<last; i++)
+			squares[i] = (long)i*i;
+	});
+	long sum = 0;
+	for(long s : squares)
+		sum += s;
+	std::cout << "sum of squares: " << sum << std::endl;
+
+	// the first exception reaches the caller, and the pool stays usable
+	try
+	{
+		pool.parallel_for(0, 1000, [](int first, int last)
+		{
+			for(int i=first; i<last; i++)
+				if(i == 637)
+					throw std::runtime_error("failed at 637");
+		});
+	}
+	catch(const std::runtime_error& e)
+	{
+		std::cout << "caught: " << e.what() << std::endl;
+	}
+
+	// nested loops run serially inside the outer one
+	std::atomic<long> nested = 0;
+	pool.parallel_for(0, 100, [&](int first, int last)
+	{
+		for(int i=first; i<last; i++)
+			pool.parallel_for(0, 100, [&](int inner_first, int inner_last)
+			{
+				nested += inner_last - inner_first;
+			});
+	});
+	std::cout << "nested: " << nested << std::endl;
+
+	// concurrent callers: one gets the pool, the others run their loops themselves
+	std::vector<long> totals(4);
+	std::vector<std::thread> callers;
+	for(int t=0; t<4; t++)
+	{
+		callers.emplace_back([&pool, &totals, t]()
+		{
+			for(int repeat=0; repeat<50; repeat++)
+			{
+				std::atomic<long> total = 0;
+				pool.parallel_for(0, 10000, [&](int first, int last)
+				{
+					long s = 0;
+					for(int i=first; i<last; i++)
+						s += i;
+					total += s;
+				});
+				totals[t] += total;
+			}
+		});
+	}
+	for(auto& caller : callers)
+		caller.join();
+	std::cout << "concurrent: " << totals[0] << " " << totals[1] << " " << totals[2] << " " << totals[3] << std::endl;
+}